@@ -0,0 +1,175 @@
+#include "ask.h"
+#include "ps.h"
+#include "ctx.h"
+#include <limits.h>
+
+/*******************************************
+ * Code related to request/reply timeouts. *
+ *******************************************/
+
+#define M_ASK_NOT_PENDING       SIZE_MAX
+
+static void ask_dtor(void *data);
+static inline void heap_set(ctx_asks_t *asks, size_t idx, ask_t *ask);
+static void heap_sift_up(ctx_asks_t *asks, size_t idx);
+static void heap_sift_down(ctx_asks_t *asks, size_t idx);
+static ask_t *heap_remove(ctx_asks_t *asks, size_t idx);
+
+static void ask_dtor(void *data) {
+    ask_t *ask = (ask_t *)data;
+    m_mem_unref(ask->reply);
+    m_mem_unref(ask->requester);
+}
+
+static inline void heap_set(ctx_asks_t *asks, size_t idx, ask_t *ask) {
+    asks->heap[idx] = ask;
+    ask->heap_idx = idx;
+}
+
+static void heap_sift_up(ctx_asks_t *asks, size_t idx) {
+    ask_t *ask = asks->heap[idx];
+    while (idx > 0) {
+        const size_t parent = (idx - 1) / 2;
+        if (asks->heap[parent]->deadline <= ask->deadline) {
+            break;
+        }
+        heap_set(asks, idx, asks->heap[parent]);
+        idx = parent;
+    }
+    heap_set(asks, idx, ask);
+}
+
+static void heap_sift_down(ctx_asks_t *asks, size_t idx) {
+    ask_t *ask = asks->heap[idx];
+    for (;;) {
+        size_t child = 2 * idx + 1;
+        if (child >= asks->len) {
+            break;
+        }
+        if (child + 1 < asks->len && asks->heap[child + 1]->deadline < asks->heap[child]->deadline) {
+            child++;
+        }
+        if (ask->deadline <= asks->heap[child]->deadline) {
+            break;
+        }
+        heap_set(asks, idx, asks->heap[child]);
+        idx = child;
+    }
+    heap_set(asks, idx, ask);
+}
+
+/* Remove a request from heap, returning heap reference to caller */
+static ask_t *heap_remove(ctx_asks_t *asks, size_t idx) {
+    ask_t *ask = asks->heap[idx];
+    ask->heap_idx = M_ASK_NOT_PENDING;
+    if (idx != --asks->len) {
+        ask_t *last = asks->heap[asks->len];
+        heap_set(asks, idx, last);
+        heap_sift_down(asks, idx);
+        heap_sift_up(asks, last->heap_idx);
+    }
+    return ask;
+}
+
+/** Private API **/
+
+ask_t *ask_new(m_mod_t *requester, uint64_t timeout_ns, const void *userptr) {
+    ask_t *ask = m_mem_new(sizeof(ask_t), ask_dtor);
+    if (ask) {
+        uint64_t now;
+        fetch_ns(&now);
+        ask->requester = m_mem_ref(requester);
+        ask->userptr = userptr;
+        ask->deadline = now + timeout_ns;
+        ask->heap_idx = M_ASK_NOT_PENDING;
+    }
+    return ask;
+}
+
+/* Store a request in ctx pending requests, until it is replied or it times out */
+int ask_track(m_ctx_t *c, ask_t *ask) {
+    ctx_asks_t *asks = &c->asks;
+
+    if (asks->len == asks->size) {
+        const size_t size = asks->size ? asks->size << 1 : M_ASK_HEAP_MIN_LEN;
+        ask_t **heap = memhook._malloc(size * sizeof(ask_t *));
+        M_ALLOC_ASSERT(heap);
+        if (asks->len > 0) {
+            memcpy(heap, asks->heap, asks->len * sizeof(ask_t *));
+        }
+        memhook._free(asks->heap);
+        asks->heap = heap;
+        asks->size = size;
+    }
+    heap_set(asks, asks->len++, m_mem_ref(ask));
+    heap_sift_up(asks, ask->heap_idx);
+    return 0;
+}
+
+/* Requester was told a reply or a timeout: stop tracking the request */
+void ask_done(m_ctx_t *c, ask_t *ask) {
+    ask->done = true;
+    if (ask->heap_idx != M_ASK_NOT_PENDING) {
+        m_mem_unref(heap_remove(&c->asks, ask->heap_idx));
+    }
+}
+
+/* Shorten poll timeout (in ms) so that loop wakes up by first pending request deadline */
+int ask_poll_timeout(m_ctx_t *c, int timeout) {
+    ctx_asks_t *asks = &c->asks;
+    if (asks->len == 0) {
+        return timeout;
+    }
+
+    uint64_t now;
+    fetch_ns(&now);
+    const uint64_t deadline = asks->heap[0]->deadline;
+    uint64_t ms = 0;
+    if (deadline > now) {
+        /* Round up: waking up before deadline would just cost another loop iteration */
+        ms = (deadline - now + 999999) / 1000000;
+        if (ms > INT_MAX) {
+            ms = INT_MAX;
+        }
+    }
+    if (timeout < 0 || ms < (uint64_t)timeout) {
+        return ms;
+    }
+    return timeout;
+}
+
+/*
+ * Tell a timeout to requesters of all expired requests.
+ * Returns number of expired requests.
+ */
+size_t ask_expire(m_ctx_t *c) {
+    ctx_asks_t *asks = &c->asks;
+    size_t expired = 0;
+
+    if (asks->len == 0) {
+        return 0;
+    }
+
+    uint64_t now;
+    fetch_ns(&now);
+    while (asks->len > 0 && asks->heap[0]->deadline <= now) {
+        ask_t *ask = heap_remove(asks, 0);
+        ask->done = true;
+        tell_ask_timeout(ask);
+        m_mem_unref(ask);
+        expired++;
+    }
+    return expired;
+}
+
+/* Drop all pending requests; any late reply will be discarded */
+void ask_clear(m_ctx_t *c) {
+    ctx_asks_t *asks = &c->asks;
+    for (size_t i = 0; i < asks->len; i++) {
+        asks->heap[i]->done = true;
+        asks->heap[i]->heap_idx = M_ASK_NOT_PENDING;
+        m_mem_unref(asks->heap[i]);
+    }
+    memhook._free(asks->heap);
+    memset(asks, 0, sizeof(ctx_asks_t));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "globals.h"
+#include "public/module/mod.h"
+
+#define M_ASK_HEAP_MIN_LEN      64      // Initial number of slots of a ctx pending requests heap
+
+/* Forward declare ctx handler */
+typedef struct _ctx m_ctx_t;
+
+/* Forward declare ps_priv_t to avoid dep cycle */
+typedef struct _ps_priv ps_priv_t;
+
+/*
+ * Request sent through m_mod_ps_ask(), ref counted:
+ * it is referenced by the request envelope, by each reply envelope,
+ * by requester ctx pending requests heap, and finally by the reply event.
+ */
+typedef struct _ask {
+    m_evt_ask_t evt;                        // Reply event; must be first member as evt_dtor() unrefs it
+    m_mod_t *requester;                     // Ref to requester module
+    const void *userptr;                    // Requester userptr, set as reply event userdata
+    uint64_t deadline;                      // Absolute timeout, in ns
+    size_t heap_idx;                        // Position inside requester ctx heap, while pending
+    bool done;                              // Whether requester was already told a reply or a timeout
+    ps_priv_t *reply;                       // Ref to delivered reply envelope, that owns reply data
+} ask_t;
+
+/*
+ * Ctx pending requests, as a binary min-heap on their deadline:
+ * a single structure for all of them, instead of a timer source each.
+ * It is only accessed by ctx thread.
+ */
+typedef struct {
+    ask_t **heap;
+    size_t len;                             // Number of pending requests
+    size_t size;                            // Number of slots
+} ctx_asks_t;
+
+ask_t *ask_new(m_mod_t *requester, uint64_t timeout_ns, const void *userptr);
+int ask_track(m_ctx_t *c, ask_t *ask);
+void ask_done(m_ctx_t *c, ask_t *ask);
+int ask_poll_timeout(m_ctx_t *c, int timeout);
+size_t ask_expire(m_ctx_t *c);
+void ask_clear(m_ctx_t *c);
@@ -10,6 +10,8 @@
 
 static pthread_key_t key;
 static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static m_list_t *ctxs;                                          // Registered contexts, for M_PS_GLOBAL messages
+static pthread_mutex_t ctxs_mx = PTHREAD_MUTEX_INITIALIZER;     // Protects ctxs list
 
 static void make_key(void);
 static void ctx_dtor(void *data);
@@ -18,10 +20,14 @@ static int loop_start(m_ctx_t *c, int max_events);
 static uint8_t loop_stop(m_ctx_t *c);
 static inline int loop_quit(m_ctx_t *c, uint8_t quit_code);
 static void push_evt(m_mod_t *mod, evt_priv_t *evt);
+static int dispatch_evt(m_mod_t *mod, ev_src_t *src, evt_priv_t *evt);
+static int recv_ps_evts(m_ctx_t *c, m_mod_t *mod);
+static int recv_mbox_evts(m_ctx_t *c);
 static int recv_events(m_ctx_t *c, int timeout);
 static int m_ctx_loop_events(m_ctx_t *c, int max_events);
 static int ctx_destroy_mods(void *data, const char *key, void *value);
 static ev_src_t *process_tick(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt);
+static ev_src_t *process_doorbell(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt);
 static int ctx_new(const char *ctx_name, m_ctx_flags flags, const void *userdata);
 
 static void make_key(void) {
@@ -33,6 +39,15 @@ static void ctx_dtor(void *data) {
     M_DEBUG("Ctx '%s' dtor.\n", context->name);
 
     deregister_ctx_src(context, &context->tick.src);
+    deregister_ctx_src(context, &context->doorbell.src);
+    m_queue_free(&context->doorbell.ready);
+    for (size_t i = 0; i < context->ps_idx.topics_len; i++) {
+        m_list_free(&context->ps_idx.topics[i]);
+    }
+    memhook._free(context->ps_idx.topics);
+    m_list_free(&context->ps_idx.regexes);
+    ask_clear(context);
+    inbox_destroy(&context->inbox);
     m_map_free(&context->modules);
     poll_destroy(&context->ppriv);
     memhook._free(context->ppriv.data);
@@ -69,16 +84,23 @@ static int loop_start(m_ctx_t *c, int max_events) {
         c->quit = false;
         c->quit_code = 0;
         
+        /* Start receiving messages enqueued in modules' mailboxes or sent by other contexts */
+        poll_set_new_evt(&c->ppriv, c->doorbell.src, ADD);
+        inbox_set_pollable(c, true);
+        
         /* Eventually start any IDLE module */
         m_iterate(c->modules, evaluate_module, NULL);
 
         /* Publish loop started system message */
-        tell_system_pubsub_msg(NULL, c, NULL, M_PS_CTX_STARTED);
+        tell_system_pubsub_msg(NULL, c, NULL, M_PS_TOPIC_CTX_STARTED);
         
         /* Start the tick source right now! */
         if (c->tick.src) {
             poll_set_new_evt(&c->ppriv, c->tick.src, ADD);
         }
+        
+        /* Wake up the loop if any message was enqueued while ctx was not looping */
+        mbox_ring(c);
     }
     return ret;
 }
@@ -87,11 +109,14 @@ static uint8_t loop_stop(m_ctx_t *c) {
     c->state = M_CTX_IDLE;
     
     /* Publish loop stopped system message */
-    tell_system_pubsub_msg(NULL, c, NULL, M_PS_CTX_STOPPED);
+    tell_system_pubsub_msg(NULL, c, NULL, M_PS_TOPIC_CTX_STOPPED);
     
     /* Flush pubsub msg to avoid memleaks */
     m_iterate(c->modules, flush_pubsub_msgs, NULL);
     
+    /* Pending requests do not survive the loop: their replies will be discarded */
+    ask_clear(c);
+    
     /* Stop FS */
     fs_stop(c);
 
@@ -100,6 +125,14 @@ static uint8_t loop_stop(m_ctx_t *c) {
         poll_set_new_evt(&c->ppriv, c->tick.src, RM);
     }
     
+    /* 
+     * Stop the doorbell too; 
+     * messages enqueued from now on will be received on next loop start.
+     */
+    inbox_set_pollable(c, false);
+    poll_set_new_evt(&c->ppriv, c->doorbell.src, RM);
+    c->doorbell.rung = false;
+    
     poll_clear(&c->ppriv);
 
     /* Destroy thpool eventually waiting on currently running tasks */
@@ -207,6 +240,114 @@ static void push_evt(m_mod_t *mod, evt_priv_t *evt) {
     }
 }
 
+/*
+ * Dispatch an already processed event to its module.
+ * Returns 1 if an event was actually received, 0 otherwise.
+ */
+static int dispatch_evt(m_mod_t *mod, ev_src_t *src, evt_priv_t *evt) {
+    m_evt_t *msg = &evt->evt;
+    
+    /* 
+     * Remove the source if it was a oneshot event.
+     * NOTE: this will reduce refs counter for evt->src to just 1,
+     * ie: it stays alive because it is needed by an evt
+     */
+    if (src && src->flags & M_SRC_ONESHOT) {
+        if (src->type != M_SRC_TYPE_PS) {
+            m_bst_remove(mod->srcs[src->type], src);
+        } else {
+            m_map_remove(mod->subscriptions, src->ps_src.topic);
+        }
+    }
+    
+    /*
+     * All messages share same address inside union.
+     * In this case, check that any message was actually received,
+     * and it was from a know source type.
+     */
+    if (!msg->fd_evt) {
+        /*
+         * Unref the evt if it wasn't consumed 
+         * by user callback to avoid memleaks,
+         */
+        m_mem_unref(evt);
+        return 0;
+    }
+    
+    if (msg->type != M_SRC_TYPE_PS || msg->ps_evt->topic_id != M_PS_TOPIC_MOD_POISONPILL) {
+        push_evt(mod, evt);
+    } else {
+        M_INFO("PoisonPilling '%s'.\n", mod->name);
+        m_mem_unref(evt);
+        stop(mod, true);
+    }
+    return 1;
+}
+
+/*
+ * Fetch up to M_PS_MAX_DRAIN pubsub messages from a module mailbox,
+ * and dispatch all of them.
+ * Returns number of received events.
+ */
+static int recv_ps_evts(m_ctx_t *c, m_mod_t *mod) {
+    mbox_msg_t msgs[M_PS_MAX_DRAIN];
+    
+    const ssize_t len = mbox_drain(mod, msgs, M_PS_MAX_DRAIN);
+    int recved = 0;
+    
+    /*
+     * Keep a reference on mod, to avoid that
+     * a m_mod_deregister() or m_mod_stop() call by user callback
+     * invalidates our pointer while we are dispatching the batch.
+     */
+    M_MEM_LOCK(mod, {
+        for (ssize_t i = 0; i < len; i++) {
+            evt_priv_t *evt = NULL;
+            /*
+             * If module was stopped by a previous message in this batch,
+             * just destroy remaining messages, as flush_pubsub_msgs() would have done.
+             */
+            if (!m_mod_is(mod, M_MOD_STOPPED | M_MOD_ZOMBIE)) {
+                evt = new_ps_evt(&msgs[i]);
+            } else {
+                m_mem_unref(msgs[i].env);
+                m_mem_unref(msgs[i].sub);
+            }
+            if (!evt) {
+                continue;
+            }
+            
+            fetch_ms(&evt->evt.ts, NULL);
+            M_INFO("'%s' received %u type evt.\n", mod->name, evt->evt.type);
+            recved += dispatch_evt(mod, evt->src, evt);
+        }
+    });
+    return recved;
+}
+
+/*
+ * Receive pubsub messages for modules that were
+ * in the ready list when this function was called;
+ * modules made ready while dispatching will be served on next loop iteration.
+ */
+static int recv_mbox_evts(m_ctx_t *c) {
+    int recved = 0;
+    
+    for (size_t i = m_queue_len(c->doorbell.ready); i > 0; i--) {
+        m_mod_t *mod = m_queue_peek(c->doorbell.ready);
+        mod->mbox.ready = false;
+        if (m_mod_is(mod, M_MOD_RUNNING)) {
+            recved += recv_ps_evts(c, mod);
+            
+            /* Any leftover message will be received on next loop iteration */
+            mbox_ready(mod);
+        }
+        /* Drop ready list reference on mod */
+        m_queue_remove(c->doorbell.ready);
+    }
+    return recved;
+}
+
 static int recv_events(m_ctx_t *c, int timeout) {
     static uint64_t last_time_called;
 
@@ -218,6 +359,15 @@ static int recv_events(m_ctx_t *c, int timeout) {
     int err;
     int recved = 0;
 
+    /* Do not block if any module has still got pending messages */
+    if (m_queue_len(c->doorbell.ready) > 0) {
+        timeout = 0;
+    } else {
+        /* Wake up in time for first pending request timeout */
+        timeout = ask_poll_timeout(c, timeout);
+    }
+    c->dispatching = true;
+    
     errno = 0;
     const int nfds = poll_wait(&c->ppriv, timeout);
     err = errno; // store any errno happened in poll_wait
@@ -234,63 +384,26 @@ static int recv_events(m_ctx_t *c, int timeout) {
             if (!p->mod) {
                 // It is a ctx priv event
                 p = p->process(p, c, i, NULL);
-                recved++;
+                if (p != c->doorbell.src) {
+                    recved++;
+                }
                 continue;
             }
 
-            /*
-             * Keep a reference on mod, to avoid that
-             * a m_mod_deregister() call by user callback
-             * invalidates our pointer.
-             */
             m_mod_t *mod = p->mod;
             evt_priv_t *evt = new_evt(p);
-            m_evt_t *msg = NULL;
-            if (evt) {
-                msg = &evt->evt;
-                fetch_ms(&msg->ts, NULL);
-                M_INFO("'%s' received %u type evt.\n", mod->name, msg->type);
-                p = p->process(p, c, i, evt);
+            if (!evt) {
+                err = ENOMEM;
+                break;
             }
+            
+            fetch_ms(&evt->evt.ts, NULL);
+            M_INFO("'%s' received %u type evt.\n", mod->name, evt->evt.type);
+            p = p->process(p, c, i, evt);
             err = errno; // Store any errno that happened while consuming events
-            bool msg_consumed = false;
-
             if (err == 0) {
-                /* 
-                 * Remove the source if it was a oneshot event.
-                 * NOTE: this will reduce refs counter for evt->src to just 1,
-                 * ie: it stays alive because it is needed by an evt
-                 */
-                if (p && p->flags & M_SRC_ONESHOT) {
-                    if (p->type != M_SRC_TYPE_PS) {
-                        m_bst_remove(mod->srcs[p->type], p);
-                    } else {
-                        m_map_remove(mod->subscriptions, p->ps_src.topic);
-                    }
-                }
-                
-                /*
-                 * All messages share same address inside union.
-                 * In this case, check that any message was actually received,
-                 * and it was from a know source type.
-                 */
-                if (msg->fd_evt) {
-                    recved++;
-                    if (msg->type != M_SRC_TYPE_PS || !msg->ps_evt->topic || strcmp(msg->ps_evt->topic, M_PS_MOD_POISONPILL)) {
-                        push_evt(mod, evt);
-                        msg_consumed = true;
-                    } else {
-                        M_INFO("PoisonPilling '%s'.\n", mod->name);
-                        stop(mod, true);
-                    }
-                }
-            }
-
-            if (!msg_consumed) {
-                /*
-                 * Unref the evt if it wasn't consumed 
-                 * by user callback to avoid memleaks,
-                 */
+                recved += dispatch_evt(mod, p, evt);
+            } else {
                 m_mem_unref(evt);
             }
         } else {
@@ -300,6 +413,21 @@ static int recv_events(m_ctx_t *c, int timeout) {
         }
     }
 
+    if (!err) {
+        // Move messages sent by other contexts to their recipients' mailboxes
+        inbox_recv(c);
+        
+        // Tell a timeout for expired requests whose reply was not received
+        ask_expire(c);
+        
+        // Pubsub messages are received in bulk from modules' mailboxes
+        recved += recv_mbox_evts(c);
+        
+        // Room was made in modules' mailboxes: wake up any blocked sender
+        inbox_wake(c);
+    }
+    c->dispatching = false;
+
     if (recved > 0 && err == 0) {
         m_iterate(c->modules, evaluate_module, NULL);
         c->stats.recv_msgs += recved;
@@ -337,7 +465,14 @@ static int ctx_destroy_mods(void *data, const char *key, void *value) {
 
 static ev_src_t *process_tick(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt) {
     poll_consume_tmr(&c->ppriv, idx, this, NULL);
-    tell_system_pubsub_msg(NULL, c, NULL, M_PS_CTX_TICK);
+    tell_system_pubsub_msg(NULL, c, NULL, M_PS_TOPIC_CTX_TICK);
+    return this;
+}
+
+static ev_src_t *process_doorbell(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt) {
+    m_evt_task_t task_evt;
+    poll_consume_task(&c->ppriv, idx, this, &task_evt);
+    c->doorbell.rung = false;
     return this;
 }
 
@@ -361,6 +496,18 @@ static int ctx_new(const char *ctx_name, m_ctx_flags flags, const void *userdata
         if (!new_ctx->modules) {
             break;
         }
+        
+        ret = inbox_init(&new_ctx->inbox);
+        if (ret != 0) {
+            break;
+        }
+        
+        new_ctx->doorbell.ready = m_queue_new(mem_dtor);
+        new_ctx->doorbell.src = register_ctx_src(new_ctx, M_SRC_TYPE_TASK, process_doorbell, &new_ctx->doorbell.tid);
+        if (!new_ctx->doorbell.ready || !new_ctx->doorbell.src) {
+            ret = -ENOMEM;
+            break;
+        }
 
         if (new_ctx->flags & M_CTX_NAME_DUP) {
             new_ctx->flags |= M_CTX_NAME_AUTOFREE;
@@ -374,6 +521,19 @@ static int ctx_new(const char *ctx_name, m_ctx_flags flags, const void *userdata
         }
 
         ret = pthread_setspecific(key, new_ctx);
+        if (ret != 0) {
+            break;
+        }
+        
+        pthread_mutex_lock(&ctxs_mx);
+        if (!ctxs) {
+            ctxs = m_list_new(NULL, NULL);
+        }
+        ret = ctxs ? m_list_insert(ctxs, new_ctx) : -ENOMEM;
+        pthread_mutex_unlock(&ctxs_mx);
+        if (ret != 0) {
+            pthread_setspecific(key, NULL);
+        }
     } while (false);
     
     if (ret != 0) {
@@ -399,6 +559,28 @@ void inline ctx_logger(const m_ctx_t *c, const m_mod_t *mod, const char *fmt, ..
     va_end(args);
 }
 
+/*
+ * Send a message to any other registered context,
+ * whose loop will tell it to its modules.
+ */
+int ctx_publish_global(const m_ctx_t *c, ps_priv_t *env) {
+    int ret = 0;
+    
+    pthread_mutex_lock(&ctxs_mx);
+    m_itr_foreach(ctxs, {
+        m_ctx_t *other = m_itr_get(m_itr);
+        if (other != c) {
+            const int err = inbox_push(other, env, NULL);
+            if (err != 0) {
+                M_DEBUG("Failed to send message to ctx '%s': %s\n", other->name, strerror(-err));
+                ret = err;
+            }
+        }
+    });
+    pthread_mutex_unlock(&ctxs_mx);
+    return ret;
+}
+
 /** Public API **/
 
 _public_ int m_ctx_register(const char *ctx_name, m_ctx_flags flags, const void *userdata) {
@@ -417,7 +599,19 @@ _public_ int m_ctx_deregister(void) {
 
     int ret = pthread_setspecific(key, NULL);
     if (ret == 0) {
+        pthread_mutex_lock(&ctxs_mx);
+        m_list_remove(ctxs, c);
+        if (m_list_len(ctxs) == 0) {
+            m_list_free(&ctxs);
+        }
+        pthread_mutex_unlock(&ctxs_mx);
+        
+        /* Other contexts cannot reach us anymore */
+        inbox_close(c);
+        
         m_iterate(c->modules, ctx_destroy_mods, NULL);
+        /* Drop any module reference still held by doorbell ready list */
+        m_queue_clear(c->doorbell.ready);
         m_mem_unref(c);
     }
     return ret;
@@ -463,7 +657,11 @@ _public_ int m_ctx_dispatch(void) {
     }
 
     /* Recv new events, no timeout */
-    return recv_events(c, 0);
+    int ret = recv_events(c, 0);
+    
+    /* Wake up any external poller if some module has still got pending messages */
+    mbox_ring(c);
+    return ret;
 }
 
 _public_ int m_ctx_dump(void) {
@@ -5,6 +5,8 @@
 #include "public/module/thpool/thpool.h"
 #include "globals.h"
 #include "src.h"
+#include "inbox.h"
+#include "ask.h"
 
 #define M_CTX_DEFAULT_EVENTS    64
 
@@ -37,6 +39,20 @@ typedef struct {
     ev_src_t *src;
 } ctx_tick_t;
 
+typedef struct {
+    m_src_task_t tid;
+    ev_src_t *src;                          // Doorbell src, signalled to wake up the loop when a module has new pubsub messages
+    m_queue_t *ready;                       // Running modules with pending messages in their mailbox
+    bool rung;                              // Whether doorbell src is currently signalled
+} ctx_doorbell_t;
+
+typedef struct {
+    m_list_t **topics;                      // Subscriptions indexed by their interned topic id (array of lists of ev_src_t*)
+    size_t topics_len;                      // Number of slots in topics array
+    m_list_t *regexes;                      // Subscriptions to be matched against published topic through regexec
+    uint64_t stamp;                         // Incremented on each publish, to tell a message only once to each module
+} ctx_ps_idx_t;
+
 /* Struct that holds data for context */
 /*
  * MEM-REFS for ctx:
@@ -59,8 +75,14 @@ struct _ctx {
     ctx_stats_t stats;                      // Context' stats
     m_thpool_t  *thpool;                    // thpool for M_SRC_TYPE_TASK srcs; lazily created
     ctx_tick_t tick;                        // Tick for ctx sending a M_PS_CTX_TICK message
+    ctx_doorbell_t doorbell;                // Doorbell for modules' mailboxes
+    ctx_ps_idx_t ps_idx;                    // Ctx-wide subscriptions index; lazily created
+    inbox_t inbox;                          // Messages sent by other contexts
+    ctx_asks_t asks;                        // Pending m_mod_ps_ask() requests sent by ctx modules
+    bool dispatching;                       // Whether ctx is currently dispatching events
     CONST const void *userdata;             // Context's user defined data
 };
 
 m_ctx_t *m_ctx(void);
 void ctx_logger(const m_ctx_t *c, const m_mod_t *mod, const char *fmt, ...);
+int ctx_publish_global(const m_ctx_t *c, ps_priv_t *env);
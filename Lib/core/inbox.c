@@ -0,0 +1,167 @@
+#include "inbox.h"
+#include "ps.h"
+#include "poll.h"
+
+/*****************************************
+ * Code related to contexts' inboxes.    *
+ *****************************************/
+
+static inbox_msg_t *inbox_take(inbox_t *ib, size_t *len);
+static void inbox_drop(inbox_msg_t *msgs, size_t len);
+
+/* Steal all pending messages; called with ib->mx held */
+static inbox_msg_t *inbox_take(inbox_t *ib, size_t *len) {
+    inbox_msg_t *msgs = ib->msgs;
+    *len = ib->len;
+    ib->msgs = NULL;
+    ib->size = 0;
+    __atomic_store_n(&ib->len, 0, __ATOMIC_RELEASE);
+    return msgs;
+}
+
+static void inbox_drop(inbox_msg_t *msgs, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        m_mem_unref(msgs[i].env);
+        if (msgs[i].recipient) {
+            __atomic_sub_fetch(&msgs[i].recipient->mbox.inflight, 1, __ATOMIC_RELAXED);
+            m_mem_unref(msgs[i].recipient);
+        }
+    }
+    memhook._free(msgs);
+}
+
+/** Private API **/
+
+int inbox_init(inbox_t *ib) {
+    int ret = pthread_mutex_init(&ib->mx, NULL);
+    if (ret == 0) {
+        ret = pthread_cond_init(&ib->cv, NULL);
+        if (ret != 0) {
+            pthread_mutex_destroy(&ib->mx);
+        }
+    }
+    return -ret;
+}
+
+/*
+ * Push a message to a ctx inbox, taking a reference on both envelope and recipient.
+ * Can be called by any thread; ctx doorbell is signalled
+ * when inbox goes from empty to non-empty.
+ * For M_MOD_MBOX_BLOCK recipients, caller is blocked until
+ * recipient mailbox has room for the message (or ctx is deregistered).
+ */
+int inbox_push(m_ctx_t *c, ps_priv_t *env, m_mod_t *recipient) {
+    inbox_t *ib = &c->inbox;
+    int ret = 0;
+
+    pthread_mutex_lock(&ib->mx);
+    if (recipient && __atomic_load_n(&recipient->mbox.policy, __ATOMIC_RELAXED) == M_MOD_MBOX_BLOCK) {
+        mbox_t *mb = &recipient->mbox;
+        __atomic_add_fetch(&ib->waiters, 1, __ATOMIC_SEQ_CST);
+        while (!ib->closed &&
+               mbox_len(mb) + __atomic_load_n(&mb->inflight, __ATOMIC_RELAXED) >= __atomic_load_n(&mb->capacity, __ATOMIC_RELAXED)) {
+            pthread_cond_wait(&ib->cv, &ib->mx);
+        }
+        __atomic_sub_fetch(&ib->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+    if (ib->closed) {
+        ret = -EPIPE;
+        goto end;
+    }
+    if (ib->len == ib->size) {
+        const size_t size = ib->size ? ib->size << 1 : M_INBOX_MIN_LEN;
+        inbox_msg_t *msgs = memhook._malloc(size * sizeof(inbox_msg_t));
+        if (!msgs) {
+            ret = -ENOMEM;
+            goto end;
+        }
+        if (ib->len > 0) {
+            memcpy(msgs, ib->msgs, ib->len * sizeof(inbox_msg_t));
+        }
+        memhook._free(ib->msgs);
+        ib->msgs = msgs;
+        ib->size = size;
+    }
+    ib->msgs[ib->len].env = m_mem_ref(env);
+    ib->msgs[ib->len].recipient = m_mem_ref(recipient);
+    if (recipient) {
+        __atomic_add_fetch(&recipient->mbox.inflight, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&ib->len, ib->len + 1, __ATOMIC_RELEASE);
+    if (ib->len == 1 && ib->pollable) {
+        poll_notify_userevent(&c->ppriv, c->doorbell.src);
+    }
+
+end:
+    pthread_mutex_unlock(&ib->mx);
+    return ret;
+}
+
+/*
+ * Tell all messages received from other ctxs;
+ * they are just moved to recipients' mailboxes.
+ * Returns number of received messages.
+ */
+ssize_t inbox_recv(m_ctx_t *c) {
+    inbox_t *ib = &c->inbox;
+    size_t len;
+
+    /* Avoid locking the mutex when there is nothing to be received */
+    if (__atomic_load_n(&ib->len, __ATOMIC_ACQUIRE) == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&ib->mx);
+    inbox_msg_t *msgs = inbox_take(ib, &len);
+    pthread_mutex_unlock(&ib->mx);
+
+    for (size_t i = 0; i < len; i++) {
+        tell_inbox_msg(c, msgs[i].env, msgs[i].recipient);
+    }
+    inbox_drop(msgs, len);
+    return len;
+}
+
+/* Ctx doorbell can be signalled only while it is polled */
+void inbox_set_pollable(m_ctx_t *c, bool pollable) {
+    inbox_t *ib = &c->inbox;
+
+    pthread_mutex_lock(&ib->mx);
+    ib->pollable = pollable;
+    if (pollable && ib->len > 0) {
+        poll_notify_userevent(&c->ppriv, c->doorbell.src);
+    }
+    pthread_mutex_unlock(&ib->mx);
+}
+
+/* Stop accepting messages, destroying any pending one */
+void inbox_close(m_ctx_t *c) {
+    inbox_t *ib = &c->inbox;
+    size_t len;
+
+    pthread_mutex_lock(&ib->mx);
+    ib->closed = true;
+    ib->pollable = false;
+    inbox_msg_t *msgs = inbox_take(ib, &len);
+    pthread_cond_broadcast(&ib->cv);
+    pthread_mutex_unlock(&ib->mx);
+
+    inbox_drop(msgs, len);
+}
+
+/* Wake up senders blocked on a full mailbox of this ctx, if any */
+void inbox_wake(m_ctx_t *c) {
+    inbox_t *ib = &c->inbox;
+
+    if (__atomic_load_n(&ib->waiters, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&ib->mx);
+        pthread_cond_broadcast(&ib->cv);
+        pthread_mutex_unlock(&ib->mx);
+    }
+}
+
+void inbox_destroy(inbox_t *ib) {
+    inbox_drop(ib->msgs, ib->len);
+    pthread_cond_destroy(&ib->cv);
+    pthread_mutex_destroy(&ib->mx);
+}
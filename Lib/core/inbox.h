@@ -0,0 +1,41 @@
+#pragma once
+
+#include "globals.h"
+#include <pthread.h>
+
+#define M_INBOX_MIN_LEN         16      // Initial number of slots of a ctx inbox
+
+/* Forward declare ps_priv_t to avoid dep cycle */
+typedef struct _ps_priv ps_priv_t;
+
+/* Forward declare ctx handler */
+typedef struct _ctx m_ctx_t;
+
+/* Message sent to a ctx by another ctx */
+typedef struct {
+    ps_priv_t *env;                         // Ref to shared message envelope
+    m_mod_t *recipient;                     // Ref to recipient module; NULL for publish and broadcast
+} inbox_msg_t;
+
+/*
+ * Ctx inbox: multiple producers (any thread) push messages,
+ * and ctx loop drains all of them at once, on its own thread.
+ */
+typedef struct {
+    pthread_mutex_t mx;                     // Protects all below fields
+    pthread_cond_t cv;                      // Signalled when room is made in a mailbox, for blocked senders
+    size_t waiters;                         // Number of blocked senders, atomically accessed
+    inbox_msg_t *msgs;                      // Pending messages
+    size_t len;                             // Number of pending messages
+    size_t size;                            // Number of slots
+    bool pollable;                          // Whether ctx doorbell is currently polled, ie: it can be signalled
+    bool closed;                            // Whether ctx was deregistered, ie: no more messages are accepted
+} inbox_t;
+
+int inbox_init(inbox_t *ib);
+int inbox_push(m_ctx_t *c, ps_priv_t *env, m_mod_t *recipient);
+ssize_t inbox_recv(m_ctx_t *c);
+void inbox_set_pollable(m_ctx_t *c, bool pollable);
+void inbox_close(m_ctx_t *c);
+void inbox_wake(m_ctx_t *c);
+void inbox_destroy(inbox_t *ib);
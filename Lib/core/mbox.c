@@ -0,0 +1,241 @@
+#include "mbox.h"
+#include "poll.h"
+
+/*****************************************
+ * Code related to modules' mailboxes.   *
+ *****************************************/
+
+static int queue_grow(mbox_queue_t *q);
+static inline size_t queue_len(const mbox_queue_t *q);
+static size_t queue_drain(mbox_queue_t *q, mbox_msg_t *msgs, size_t len);
+static void queue_drop_oldest(mbox_queue_t *q);
+static inline mbox_prio_t msg_prio(const ev_src_t *sub);
+static inline void msg_moved(mbox_msg_t *m);
+static inline void msg_taken(mbox_msg_t *m);
+static void mbox_set(size_t *idx, size_t val);
+
+static int queue_grow(mbox_queue_t *q) {
+    const size_t size = q->size ? q->size << 1 : M_MBOX_MIN_LEN;
+    
+    mbox_msg_t *msgs = memhook._malloc(size * sizeof(mbox_msg_t));
+    M_ALLOC_ASSERT(msgs);
+    
+    /* Linearize old ring into the new one */
+    const size_t len = queue_len(q);
+    for (size_t i = 0; i < len; i++) {
+        msgs[i] = q->msgs[(q->head + i) & (q->size - 1)];
+        msg_moved(&msgs[i]);
+    }
+    memhook._free(q->msgs);
+    q->msgs = msgs;
+    q->size = size;
+    mbox_set(&q->head, 0);
+    mbox_set(&q->tail, len);
+    return 0;
+}
+
+static inline size_t queue_len(const mbox_queue_t *q) {
+    return __atomic_load_n(&q->tail, __ATOMIC_RELAXED) - __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+}
+
+static size_t queue_drain(mbox_queue_t *q, mbox_msg_t *msgs, size_t len) {
+    size_t i;
+    for (i = 0; i < len && q->head + i != q->tail; i++) {
+        mbox_msg_t *m = &q->msgs[(q->head + i) & (q->size - 1)];
+        msg_taken(m);
+        msgs[i] = *m;
+    }
+    mbox_set(&q->head, q->head + i);
+    return i;
+}
+
+static void queue_drop_oldest(mbox_queue_t *q) {
+    mbox_msg_t *old = &q->msgs[q->head & (q->size - 1)];
+    msg_taken(old);
+    m_mem_unref(old->env);
+    m_mem_unref(old->sub);
+    mbox_set(&q->head, q->head + 1);
+}
+
+/* Direct tells and broadcasts have no subscription: they are normal priority */
+static inline mbox_prio_t msg_prio(const ev_src_t *sub) {
+    if (sub) {
+        if (sub->flags & M_SRC_PRIO_HIGH) {
+            return M_MBOX_PRIO_HIGH;
+        }
+        if (sub->flags & M_SRC_PRIO_LOW) {
+            return M_MBOX_PRIO_LOW;
+        }
+    }
+    return M_MBOX_PRIO_NORM;
+}
+
+/* A conflated message was stored in a (new) slot: let its subscription know where */
+static inline void msg_moved(mbox_msg_t *m) {
+    if (m->sub && (m->sub->flags & M_SRC_PS_CONFLATE)) {
+        m->sub->ps_src.pending = m;
+    }
+}
+
+/* A conflated message left the mailbox: next one will take a new slot */
+static inline void msg_taken(mbox_msg_t *m) {
+    if (m->sub && (m->sub->flags & M_SRC_PS_CONFLATE)) {
+        m->sub->ps_src.pending = NULL;
+    }
+}
+
+static inline void mbox_set(size_t *idx, size_t val) {
+    __atomic_store_n(idx, val, __ATOMIC_RELAXED);
+}
+
+/** Private API **/
+
+/*
+ * Store a message in module's mailbox, taking a reference on both envelope and subscription.
+ * Message is stored in the queue matching its subscription priority.
+ * No syscall is involved: the module is just enqueued in its ctx ready list
+ * when its mailbox goes from empty to non-empty.
+ * When mailbox is full, its overflow policy is applied:
+ * as this is always called by module's ctx thread, M_MOD_MBOX_BLOCK behaves as M_MOD_MBOX_REJECT.
+ * M_MOD_MBOX_DROP_OLDEST drops the oldest message of the lowest priority non-empty queue.
+ * Messages for a M_SRC_PS_CONFLATE subscription replace its undelivered message, if any.
+ */
+int mbox_push(m_mod_t *mod, ps_priv_t *env, ev_src_t *sub) {
+    mbox_t *mb = &mod->mbox;
+    
+    /* Last-value subscription with an undelivered message: replace it in place, even on a full mailbox */
+    if (sub && sub->ps_src.pending) {
+        m_mem_unref(sub->ps_src.pending->env);
+        sub->ps_src.pending->env = m_mem_ref(env);
+        mod->stats.conflated_msgs++;
+        return 0;
+    }
+    
+    if (mbox_full(mb)) {
+        mod->stats.dropped_msgs++;
+        switch (mb->policy) {
+        case M_MOD_MBOX_DROP_OLDEST:
+            for (int p = M_MBOX_PRIO_MAX - 1; p >= 0; p--) {
+                if (queue_len(&mb->queues[p]) > 0) {
+                    queue_drop_oldest(&mb->queues[p]);
+                    break;
+                }
+            }
+            break;
+        case M_MOD_MBOX_DROP_NEWEST:
+            return 0;
+        default:
+            return -EAGAIN;
+        }
+    }
+    
+    mbox_queue_t *q = &mb->queues[msg_prio(sub)];
+    if (queue_len(q) == q->size) {
+        int ret = queue_grow(q);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    mbox_msg_t *m = &q->msgs[q->tail & (q->size - 1)];
+    m->env = m_mem_ref(env);
+    m->sub = m_mem_ref(sub);
+    msg_moved(m);
+    mbox_set(&q->tail, q->tail + 1);
+    
+    const size_t len = mbox_len(mb);
+    if (len > mod->stats.mbox_high_watermark) {
+        mod->stats.mbox_high_watermark = len;
+    }
+    mbox_ready(mod);
+    return 0;
+}
+
+/* Fetch up to len messages from module's mailbox, high priority ones first */
+ssize_t mbox_drain(m_mod_t *mod, mbox_msg_t *msgs, size_t len) {
+    mbox_t *mb = &mod->mbox;
+    size_t i = 0;
+    for (int p = 0; p < M_MBOX_PRIO_MAX && i < len; p++) {
+        i += queue_drain(&mb->queues[p], msgs + i, len - i);
+    }
+    return i;
+}
+
+size_t mbox_len(const mbox_t *mb) {
+    size_t len = 0;
+    for (int p = 0; p < M_MBOX_PRIO_MAX; p++) {
+        len += queue_len(&mb->queues[p]);
+    }
+    return len;
+}
+
+bool mbox_full(const mbox_t *mb) {
+    return mbox_len(mb) >= __atomic_load_n(&mb->capacity, __ATOMIC_RELAXED);
+}
+
+/* Enqueue a running module with pending messages in its ctx ready list */
+void mbox_ready(m_mod_t *mod) {
+    mbox_t *mb = &mod->mbox;
+    if (!mb->ready && mbox_len(mb) > 0 && m_mod_is(mod, M_MOD_RUNNING)) {
+        M_MOD_CTX(mod);
+        if (m_queue_enqueue(c->doorbell.ready, m_mem_ref(mod)) == 0) {
+            mb->ready = true;
+            mbox_ring(c);
+        } else {
+            m_mem_unref(mod);
+        }
+    }
+}
+
+/*
+ * Destroy module's mailbox; any pending message must have already been drained.
+ * Mailbox capacity and policy are kept.
+ * Note: module may still be referenced by its ctx ready list;
+ * stale entries are just skipped by the ctx loop.
+ */
+void mbox_reset(m_mod_t *mod) {
+    mbox_t *mb = &mod->mbox;
+    for (int p = 0; p < M_MBOX_PRIO_MAX; p++) {
+        mbox_queue_t *q = &mb->queues[p];
+        memhook._free(q->msgs);
+        q->msgs = NULL;
+        q->size = 0;
+        mbox_set(&q->head, 0);
+        mbox_set(&q->tail, 0);
+    }
+    mb->ready = false;
+    
+    /* Wake up any sender blocked on this mailbox */
+    inbox_wake(mod->ctx);
+}
+
+/*
+ * Signal ctx doorbell, to wake up its loop.
+ * Doorbell is only rung on its empty to non-empty transition,
+ * and never while the ctx is dispatching events,
+ * as any pending message will be received before polling again.
+ */
+void mbox_ring(m_ctx_t *c) {
+    if (!c->doorbell.rung && !c->dispatching &&
+        c->state == M_CTX_LOOPING && m_queue_len(c->doorbell.ready) > 0) {
+        
+        if (poll_notify_userevent(&c->ppriv, c->doorbell.src) == 0) {
+            c->doorbell.rung = true;
+        }
+    }
+}
+
+/** Public API **/
+
+_public_ int m_mod_set_mailbox(m_mod_t *mod, size_t len, m_mod_mbox_policy policy) {
+    M_MOD_ASSERT(mod);
+    M_PARAM_ASSERT(len > 0);
+    M_PARAM_ASSERT(policy >= M_MOD_MBOX_REJECT && policy <= M_MOD_MBOX_BLOCK);
+    M_MOD_CONSUME_TOKEN(mod);
+    
+    __atomic_store_n(&mod->mbox.capacity, len, __ATOMIC_RELAXED);
+    __atomic_store_n(&mod->mbox.policy, policy, __ATOMIC_RELAXED);
+    
+    /* Capacity may have grown: wake up any blocked sender */
+    inbox_wake(mod->ctx);
+    return 0;
+}
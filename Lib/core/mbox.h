@@ -0,0 +1,64 @@
+#pragma once
+
+#include "globals.h"
+#include "public/module/mod.h"
+
+#define M_MBOX_MIN_LEN          16      // Initial number of slots of a module mailbox
+#define M_MBOX_MAX_LEN          8192    // Default max number of pending messages in a module mailbox
+
+/* Forward declare ps_priv_t and ev_src_t to avoid dep cycle */
+typedef struct _ps_priv ps_priv_t;
+typedef struct _ev_src ev_src_t;
+
+/* Forward declare ctx handler */
+typedef struct _ctx m_ctx_t;
+
+/* 
+ * Per-recipient pubsub message record:
+ * message envelope is shared between all recipients.
+ */
+typedef struct {
+    ps_priv_t *env;                         // Ref to shared message envelope
+    ev_src_t *sub;                          // Ref to recipient subscription; NULL for direct tell and broadcast
+} mbox_msg_t;
+
+/* Mailbox priority levels, in draining order */
+typedef enum {
+    M_MBOX_PRIO_HIGH,
+    M_MBOX_PRIO_NORM,
+    M_MBOX_PRIO_LOW,
+    M_MBOX_PRIO_MAX
+} mbox_prio_t;
+
+/*
+ * A ring buffer of pubsub messages, lazily allocated and grown.
+ * Head and tail are only written by module's ctx thread,
+ * but they are atomically accessed as other threads may read mailbox length.
+ */
+typedef struct {
+    mbox_msg_t *msgs;                       // Ring buffer of pending messages
+    size_t size;                            // Number of slots (power of 2)
+    size_t head;                            // Index of oldest pending message
+    size_t tail;                            // Index of next free slot
+} mbox_queue_t;
+
+/*
+ * Module's mailbox: a queue for each subscription priority,
+ * so that high priority messages overtake any backlog.
+ * Capacity bounds the number of pending messages in all queues.
+ */
+typedef struct {
+    mbox_queue_t queues[M_MBOX_PRIO_MAX];   // Pending messages for each priority level
+    bool ready;                             // Whether module is enqueued in its ctx ready list
+    size_t capacity;                        // Max number of pending messages
+    m_mod_mbox_policy policy;               // Policy when a message is told to a full mailbox
+    size_t inflight;                        // Direct tells by other threads still in ctx inbox, atomically accessed
+} mbox_t;
+
+int mbox_push(m_mod_t *mod, ps_priv_t *env, ev_src_t *sub);
+ssize_t mbox_drain(m_mod_t *mod, mbox_msg_t *msgs, size_t len);
+size_t mbox_len(const mbox_t *mb);
+bool mbox_full(const mbox_t *mb);
+void mbox_ready(m_mod_t *mod);
+void mbox_reset(m_mod_t *mod);
+void mbox_ring(m_ctx_t *c);
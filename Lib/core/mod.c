@@ -12,8 +12,6 @@
 enum mod_hook { MOD_EVAL, MOD_START, MOD_STOP };
 
 static void module_dtor(void *data);
-static int _pipe(m_mod_t *mod);
-static int init_pubsub_fd(m_mod_t *mod);
 static int manage_srcs(m_mod_t *mod, m_ctx_t *c, int flag, bool stop);
 static void reset_module(m_mod_t *mod);
 static int optional_hook(m_mod_t *mod, enum mod_hook req_hook);
@@ -23,8 +21,6 @@ static void module_dtor(void *data) {
     if (mod) {
         M_DEBUG("Module '%s' dtor.\n", mod->name);
         
-        m_mem_unref(mod->ctx);
-        
         if (mod->dlhandle) {
             dlclose(mod->dlhandle);
             mod->dlhandle = NULL;
@@ -46,52 +42,31 @@ static void module_dtor(void *data) {
         if (mod->flags & M_MOD_USERDATA_AUTOFREE) {
             memhook._free((void *)mod->userdata);
         }
+        
+        /* Subscriptions dtor needs mod ctx: release it last */
+        m_mem_unref(mod->ctx);
     }
 }
 
-static int _pipe(m_mod_t *mod) {
-    int ret = pipe(mod->pubsub_fd);
-    if (ret == 0) {
-        for (int i = 0; i < 2; i++) {
-            int flags = fcntl(mod->pubsub_fd[i], F_GETFL, 0);
-            if (flags == -1) {
-                flags = 0;
-            }
-            fcntl(mod->pubsub_fd[i], F_SETFL, flags | O_NONBLOCK);
-            fcntl(mod->pubsub_fd[i], F_SETFD, FD_CLOEXEC);
-        }
-    }
-    return ret;
-}
-
-static int init_pubsub_fd(m_mod_t *mod) {
-    if (_pipe(mod) == 0) {
-        fd_src_t fd_src = {0};
-        fd_src.fd = mod->pubsub_fd[0];
-        if (register_mod_src(mod, M_SRC_TYPE_PS, &fd_src, M_SRC_FD_AUTOCLOSE | M_SRC_PRIO_HIGH, NULL) == 0) {
-            return 0;
-        }
-        close(mod->pubsub_fd[0]);
-        close(mod->pubsub_fd[1]);
-        mod->pubsub_fd[0] = -1;
-        mod->pubsub_fd[1] = -1;
-    }
-    return -errno;
-}
-
 static int manage_srcs(m_mod_t *mod, m_ctx_t *c, int flag, bool stop) {
     int ret = 0;
 
+    if (flag == RM && stop) {
+        /*
+         * Free all unread pubsub msg for this module.
+         */
+        flush_pubsub_msgs(NULL, NULL, mod);
+    }
+
     for (int i = 0; i < M_SRC_TYPE_END; i++) {
         m_itr_foreach(mod->srcs[i], {
             ev_src_t *t = m_itr_get(m_itr);
             if (flag == RM && stop) {
-                if (t->type == M_SRC_TYPE_PS) {
-                    /*
-                    * Free all unread pubsub msg for this module.
-                    */
-                    flush_pubsub_msgs(NULL, NULL, mod);
-                }
+                /*
+                 * Stop polling on the source right now:
+                 * it may outlive the module state if anyone else holds a reference on it.
+                 */
+                poll_set_new_evt(&c->ppriv, t, RM);
                 ret = m_itr_rm(m_itr);
             } else {
                 ret = poll_set_new_evt(&c->ppriv, t, flag);
@@ -107,11 +82,7 @@ static int manage_srcs(m_mod_t *mod, m_ctx_t *c, int flag, bool stop) {
 }
 
 static void reset_module(m_mod_t *mod) {
-    if (mod->pubsub_fd[1] != -1) {
-        close(mod->pubsub_fd[1]);
-        mod->pubsub_fd[0] = -1;
-        mod->pubsub_fd[1] = -1;
-    }
+    mbox_reset(mod);
     m_map_clear(mod->subscriptions);
     m_stack_clear(mod->recvs);
     m_queue_clear(mod->stashed);
@@ -212,25 +183,15 @@ int evaluate_module(void *data, const char *key, void *value) {
 int start(m_mod_t *mod, bool starting) {
     static const char *errors[] = { "Failed to resume module.", "Failed to start module." };
 
-    /* 
-     * Starting module for the first time
-     * or after it was stopped.
-     * Properly add back its pubsub fds.
-     */
-    if (starting) {
-        /* THIS IS NOT A RESUME */
-        int ret = init_pubsub_fd(mod);
-        if (ret != 0) {
-            return ret;
-        }
-    }
-
     M_MOD_CTX(mod);
     int ret = manage_srcs(mod, c, ADD, false);
     M_LOG_ASSERT(!ret, errors[starting], ret);
     
     mod->state = M_MOD_RUNNING;
     c->stats.running_modules++;
+    
+    /* When resuming, receive any message enqueued while paused */
+    mbox_ready(mod);
 
     /* Call module on_start() callback only if module is being (re)started */
     if (starting) {
@@ -240,7 +201,7 @@ int start(m_mod_t *mod, bool starting) {
     switch (ret) {
     case 0:
         M_DEBUG("%s '%s'.\n", starting ? "Started" : "Resumed", mod->name);
-        tell_system_pubsub_msg(NULL, c, mod, M_PS_MOD_STARTED);
+        tell_system_pubsub_msg(NULL, c, mod, M_PS_TOPIC_MOD_STARTED);
         break;
     case -1:
         /* on_start() hook returned false, we need to stop this module right away */
@@ -268,8 +229,8 @@ int stop(m_mod_t *mod, bool stopping) {
     mod->state = stopping ? M_MOD_STOPPED : M_MOD_PAUSED;
 
     /*
-     * When module gets stopped, its write-end pubsub fd is closed too 
-     * Read-end is already closed by manage_fds().
+     * When module gets stopped, its mailbox is destroyed too 
+     * (pending messages were already flushed by manage_srcs()).
      * Moreover, its subscriptions are cleared.
      * 
      * Finally, on_stop() callback is called.
@@ -285,7 +246,7 @@ int stop(m_mod_t *mod, bool stopping) {
         break;
     default:
         M_DEBUG("%s '%s'.\n", stopping ? "Stopped" : "Paused", mod->name);
-        tell_system_pubsub_msg(NULL, c, mod, M_PS_MOD_STOPPED);
+        tell_system_pubsub_msg(NULL, c, mod, M_PS_TOPIC_MOD_STOPPED);
         ret = 0;
         break;
     }
@@ -524,6 +485,10 @@ _public_ int m_mod_register(const char *name, m_mod_t **mod_ref, const m_mod_hoo
         mod->tb.burst = UINT64_MAX;
         mod->tb.tokens = UINT64_MAX;
         
+        // Default mailbox capacity and overflow policy
+        mod->mbox.capacity = M_MBOX_MAX_LEN;
+        mod->mbox.policy = M_MOD_MBOX_REJECT;
+        
         if (m_map_put(c->modules, mod->name, mod) == 0) {
             mod->state = M_MOD_IDLE;
 
@@ -531,9 +496,6 @@ _public_ int m_mod_register(const char *name, m_mod_t **mod_ref, const m_mod_hoo
                 *mod_ref = m_mem_ref(mod);
             }
             
-            mod->pubsub_fd[0] = -1;
-            mod->pubsub_fd[1] = -1;
-            
             fetch_ms(&mod->stats.registration_time, NULL);
             return 0;
         }
@@ -631,6 +593,9 @@ _public_ int m_mod_stats(const m_mod_t *mod, m_mod_stats_t *stats) {
     stats->activity_freq = ((double)mod->stats.action_ctr) / registered_time;
     stats->recv_msgs = mod->stats.recv_msgs;
     stats->sent_msgs = mod->stats.sent_msgs;
+    stats->dropped_msgs = mod->stats.dropped_msgs;
+    stats->mbox_high_watermark = mod->stats.mbox_high_watermark;
+    stats->conflated_msgs = mod->stats.conflated_msgs;
     return 0;
 }
 
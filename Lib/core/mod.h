@@ -2,6 +2,7 @@
 
 #include "public/module/mod.h"
 #include "globals.h"
+#include "mbox.h"
 
 #define M_MOD_CTX(mod) \
     m_ctx_t *c = mod->ctx;
@@ -30,6 +31,9 @@ typedef struct {
     uint64_t action_ctr;
     uint64_t sent_msgs;
     uint64_t recv_msgs;
+    uint64_t dropped_msgs;
+    size_t mbox_high_watermark;
+    uint64_t conflated_msgs;
 } mod_stats_t;
 
 typedef struct {
@@ -61,7 +65,7 @@ typedef struct _ctx m_ctx_t;
 struct _mod {
     m_mod_states state;                     // module's state
     CONST m_mod_flags flags;                // Module's flags
-    int pubsub_fd[2];                       // In and Out pipe for pubsub msg
+    mbox_t mbox;                            // Mailbox for pubsub msg
     mod_stats_t stats;                      // Module's stats
     CONST m_mod_hook_t hook;                // module's user defined callbacks
     m_stack_t *recvs;                       // Stack of recv functions for module_become/unbecome (stack of funpointers)
@@ -73,6 +77,7 @@ struct _mod {
     CONST void *dlhandle;                   // Handle for plugin (NULL if not a plugin)
     m_bst_t *srcs[M_SRC_TYPE_END];          // module's event sources
     m_map_t *subscriptions;                 // module's subscriptions (map of ev_src_t*)
+    uint64_t ps_stamp;                      // Last ctx publish stamp this module was told
     m_queue_t *stashed;                     // module's stashed messages
     m_list_t *bound_mods;                   // modules that are bound to this module's state
     CONST m_ctx_t *ctx;                     // Module's ctx -> even if ctx is threadspecific data, we need to know the context a module was registered into, to avoid user passing modules around to another thread/context
@@ -41,7 +41,6 @@ int poll_set_new_evt(poll_priv_t *priv, ev_src_t *tmp, const enum op_type flag)
     }
     struct kevent *_ev = (struct kevent *)tmp->ev;
     switch (tmp->type) {
-    case M_SRC_TYPE_PS: // M_SRC_TYPE_PS is used for pubsub_fd[0] in init_pubsub_fd()
     case M_SRC_TYPE_FD:
         EV_SET(_ev, tmp->fd_src.fd, EVFILT_READ, f, 0, 0, tmp);
         break;
@@ -72,7 +71,8 @@ int poll_set_new_evt(poll_priv_t *priv, ev_src_t *tmp, const enum op_type flag)
         break;
     case M_SRC_TYPE_TASK:
     case M_SRC_TYPE_THRESH:
-        EV_SET(_ev, (uintptr_t)tmp, EVFILT_USER, f, NOTE_FFNOP, 0, tmp);
+        /* EV_CLEAR: reset user event state once retrieved, for non-oneshot srcs (eg: ctx doorbell) */
+        EV_SET(_ev, (uintptr_t)tmp, EVFILT_USER, f | EV_CLEAR, NOTE_FFNOP, 0, tmp);
         break;
     default: 
         break;
@@ -171,7 +171,8 @@ int poll_destroy(poll_priv_t *priv) {
 
 int poll_notify_userevent(poll_priv_t *priv, ev_src_t *src) {
     GET_PRIV_DATA();
-    struct kevent *_ev = (struct kevent *)src->ev;
-    EV_SET(_ev, (uintptr_t)src, EVFILT_USER, 0, NOTE_FFNOP | NOTE_TRIGGER, 0, src);
-    return kevent(kp->fd, _ev, 1, NULL, 0, NULL);
+    /* Use a local kevent: this can be called by any thread */
+    struct kevent ev;
+    EV_SET(&ev, (uintptr_t)src, EVFILT_USER, 0, NOTE_FFNOP | NOTE_TRIGGER, 0, src);
+    return kevent(kp->fd, &ev, 1, NULL, 0, NULL);
 }
@@ -8,85 +8,175 @@
  ******************************************/
 
 static void subscribtions_dtor(void *data);
-static ev_src_t *fetch_sub(m_mod_t *mod, const char *topic);
+static void unsubscribe_dtor(void *data);
+static int index_sub(m_ctx_t *c, ev_src_t *sub);
+static void unindex_sub(m_ctx_t *c, ev_src_t *sub);
 static inline bool is_system_message(const char *topic);
+static inline bool is_literal_topic(const char *topic);
+static inline bool has_subscribers(const m_ctx_t *c, m_ps_topic_t id);
+static int tell_mod(ps_priv_t *msg, ev_src_t *sub, m_mod_t *mod);
 static int tell_if(void *data, const char *key, void *value);
-static ps_priv_t *alloc_ps_msg(const ps_priv_t *msg, ev_src_t *sub);
+static ps_priv_t *alloc_ps_msg(bool system, m_mod_t *sender, const char *topic, m_ps_topic_t topic_id,
+                               const void *data, m_ps_flags flags);
 static void ps_msg_dtor(void *data);
 static void tell_subscribers(void *data, void *value);
 static int tell_pubsub_msg(ps_priv_t *m, const m_mod_t *recipient, m_ctx_t *c);
-static int send_msg(m_mod_t *mod, const m_mod_t *recipient, const char *topic, 
-                    const void *message, m_ps_flags flags);
+static int send_msg(m_mod_t *mod, const m_mod_t *recipient, const char *topic, m_ps_topic_t topic_id,
+                    const void *message, m_ps_flags flags, ask_t *ask);
+static int tell_reply(m_ctx_t *c, ps_priv_t *env);
+static evt_priv_t *new_ask_evt(mbox_msg_t *m);
 
 static void subscribtions_dtor(void *data) {
     ev_src_t *sub = (ev_src_t *)data;
-    regfree(&sub->ps_src.reg);
-    if (sub->flags & M_SRC_DUP) {
-        memhook._free((void *)sub->ps_src.topic);
+    if (!sub->ps_src.literal) {
+        regfree(&sub->ps_src.reg);
     }
     if (sub->flags & M_SRC_AUTOFREE) {
         memhook._free((void *)sub->userptr);
     }
 }
 
-static ev_src_t *fetch_sub(m_mod_t *mod, const char *topic) {
-    /* Check if module is directly subscribed to topic */
-    ev_src_t *sub = m_map_get(mod->subscriptions, topic);
-    if (sub) {
-        goto found;
+/*
+ * Dtor for mod->subscriptions map values:
+ * called whenever a subscription is removed, updated or cleared,
+ * it immediately drops it from ctx index too.
+ * Subscription memory may outlive it as it is referenced by pending events.
+ */
+static void unsubscribe_dtor(void *data) {
+    ev_src_t *sub = (ev_src_t *)data;
+    unindex_sub(sub->mod->ctx, sub);
+    m_mem_unref(sub);
+}
+
+/*
+ * Store a subscription in ctx index:
+ * it is indexed by its interned topic id, for modules directly subscribed to a topic,
+ * and it is stored in regexes list too, unless it is a literal topic.
+ */
+static int index_sub(m_ctx_t *c, ev_src_t *sub) {
+    ctx_ps_idx_t *idx = &c->ps_idx;
+    const m_ps_topic_t id = sub->ps_src.topic_id;
+    
+    /* Lazy index init */
+    if (!idx->regexes) {
+        idx->regexes = m_list_new(NULL, NULL);
+        M_ALLOC_ASSERT(idx->regexes);
     }
     
-    /* Check if any stored subscriptions is a regex that matches topic */
-    m_itr_foreach(mod->subscriptions, {
-        sub = m_itr_get(m_itr);
-        /* Execute regular expression */
-        int ret = regexec(&sub->ps_src.reg, topic, 0, NULL, 0);
-        if (!ret) {
-            memhook._free(m_itr);
-            goto found;
+    /* Grow topics array up to topic id */
+    if (id >= idx->topics_len) {
+        size_t len = idx->topics_len ? idx->topics_len : M_PS_IDX_MIN_LEN;
+        while (len <= id) {
+            len <<= 1;
         }
-    });
-    return NULL;
+        m_list_t **topics = memhook._calloc(len, sizeof(m_list_t *));
+        M_ALLOC_ASSERT(topics);
+        if (idx->topics_len > 0) {
+            memcpy(topics, idx->topics, idx->topics_len * sizeof(m_list_t *));
+        }
+        memhook._free(idx->topics);
+        idx->topics = topics;
+        idx->topics_len = len;
+    }
+    
+    m_list_t **subs = &idx->topics[id];
+    if (!*subs) {
+        *subs = m_list_new(NULL, NULL);
+        M_ALLOC_ASSERT(*subs);
+    }
+    
+    int ret = m_list_insert(*subs, sub);
+    if (ret == 0 && !sub->ps_src.literal) {
+        ret = m_list_insert(idx->regexes, sub);
+        if (ret != 0) {
+            m_list_remove(*subs, sub);
+        }
+    }
+    if (m_list_len(*subs) == 0) {
+        m_list_free(subs);
+    }
+    return ret;
+}
+
+static void unindex_sub(m_ctx_t *c, ev_src_t *sub) {
+    ctx_ps_idx_t *idx = &c->ps_idx;
+    const m_ps_topic_t id = sub->ps_src.topic_id;
     
-found:
-    return sub;
+    if (id < idx->topics_len && m_list_remove(idx->topics[id], sub) == 0) {
+        if (m_list_len(idx->topics[id]) == 0) {
+            m_list_free(&idx->topics[id]);
+        }
+        if (!sub->ps_src.literal) {
+            m_list_remove(idx->regexes, sub);
+        }
+    }
 }
 
 static inline bool is_system_message(const char *topic) {
     return topic && strncmp(topic, "LIBMODULE_", strlen("LIBMODULE_")) == 0;
 }
 
-/* 
- * Note: we cannot use m_mod_is() here as this function may be called
- * from another ctx when M_PS_GLOBAL is set on a broadcast message,
- * and it would fail because it is being called by different thread.
+/*
+ * A topic without any bracket expression, anchor, repetition or escape
+ * is a literal one, matched by exact comparison only.
+ * Note that '.' is considered literal too, eg: "orders.new".
  */
-static int tell_if(void *data, const char *key, void *value) {
-    m_mod_t *mod = (m_mod_t *)value;
-    ps_priv_t *msg = (ps_priv_t *)data;
-    ev_src_t *sub = msg->msg.topic ? (ev_src_t *)key : NULL;                 // key is indeed a subscription when we are publishing (check tell_subscribers()) !!
+static inline bool is_literal_topic(const char *topic) {
+    return strpbrk(topic, "[]*^$\\") == NULL;
+}
+
+/* Whether any ctx module may be subscribed to a topic, either directly or through a regex */
+static inline bool has_subscribers(const m_ctx_t *c, m_ps_topic_t id) {
+    const ctx_ps_idx_t *idx = &c->ps_idx;
+    return (id < idx->topics_len && idx->topics[id]) || (idx->regexes && m_list_len(idx->regexes) > 0);
+}
 
+/* 
+ * Note: this is always called by mod's ctx thread:
+ * messages sent by other ctxs are told by recipient ctx loop,
+ * once received from its inbox.
+ * Returns -EAGAIN if mod mailbox is full and its policy rejected the message.
+ */
+static int tell_mod(ps_priv_t *msg, ev_src_t *sub, m_mod_t *mod) {
+    int ret = 0;
     if (mod->state & (M_MOD_RUNNING | M_MOD_PAUSED) &&                       // mod is running or paused
         (!msg->msg.topic || sub)) {                                          // it is a publish and mod is subscribed on topic, or it is a broadcast/direct tell message
 
         M_DEBUG("Telling a message to '%s'\n", mod->name);
-        ps_priv_t *m = alloc_ps_msg(msg, sub);
-        if (m) {
-            if (write(mod->pubsub_fd[1], &m, sizeof(ps_priv_t *)) != sizeof(ps_priv_t *)) {
-                M_DEBUG("Failed to write message: %s\n", strerror(errno));
-                m_mem_unref(msg);
-            }
+        ret = mbox_push(mod, msg, sub);
+        if (ret != 0) {
+            M_DEBUG("Failed to store message for '%s': %s\n", mod->name, strerror(-ret));
         }
     }
+    return ret;
+}
+
+/* 
+ * Fan-out callback: a full mailbox does not stop the iteration;
+ * dropped messages are accounted in each recipient stats.
+ */
+static int tell_if(void *data, const char *key, void *value) {
+    ps_priv_t *msg = (ps_priv_t *)data;
+    ev_src_t *sub = msg->msg.topic ? (ev_src_t *)key : NULL;                 // key is indeed a subscription when we are publishing (check tell_subscribers()) !!
+
+    tell_mod(msg, sub, (m_mod_t *)value);
     return 0;
 }
 
-static ps_priv_t *alloc_ps_msg(const ps_priv_t *msg, ev_src_t *sub) {
+/*
+ * Allocate the envelope for a message;
+ * each recipient will then just store a reference to it.
+ */
+static ps_priv_t *alloc_ps_msg(bool system, m_mod_t *sender, const char *topic, m_ps_topic_t topic_id,
+                               const void *data, m_ps_flags flags) {
     ps_priv_t *m = m_mem_new(sizeof(ps_priv_t), ps_msg_dtor);
     if (m) {
-        memcpy(m, msg, sizeof(ps_priv_t));
-        m->msg.sender = m_mem_ref((void *)m->msg.sender); // keep module alive until message is dispatched
-        m->sub = sub;
+        m->msg.system = system;
+        m->msg.sender = m_mem_ref(sender); // keep module alive until message is dispatched by all recipients
+        m->msg.topic = topic;
+        m->msg.topic_id = topic_id;
+        m->msg.data = flags & M_PS_MEMREF ? m_mem_ref((void *)data) : data;
+        m->flags = flags;
     }
     return m;
 }
@@ -96,21 +186,47 @@ static void ps_msg_dtor(void *data) {
     
     if (pubsub_msg->flags & M_PS_AUTOFREE) {
         memhook._free((void *)pubsub_msg->msg.data);
+    } else if (pubsub_msg->flags & M_PS_MEMREF) {
+        m_mem_unref((void *)pubsub_msg->msg.data);
     }
     if (pubsub_msg->msg.sender) {
         m_mem_unref((void *)pubsub_msg->msg.sender);
     }
+    m_mem_unref(pubsub_msg->ask);
+    m_mem_unref(pubsub_msg->reply_to);
 }
 
+/*
+ * Tell a published message to each subscribed module, using ctx index.
+ * Each module is told at most once:
+ * a direct subscription to topic has precedence over a matching regex one.
+ */
 static void tell_subscribers(void *data, void *value) {
     m_ctx_t *c = (m_ctx_t *)value;
     ps_priv_t *msg = (ps_priv_t *)data;
+    ctx_ps_idx_t *idx = &c->ps_idx;
     
-    m_itr_foreach(c->modules, {
-        m_mod_t *mod = m_itr_get(m_itr);
-        ev_src_t *sub = NULL;
-        
-        if (m_mod_is(mod, M_MOD_RUNNING | M_MOD_PAUSED) && (sub = fetch_sub(mod, msg->msg.topic))) {
+    const uint64_t stamp = ++idx->stamp;
+    
+    /* Modules directly subscribed to topic: a plain table lookup by its interned id */
+    const m_ps_topic_t id = msg->msg.topic_id;
+    m_itr_foreach(id < idx->topics_len ? idx->topics[id] : NULL, {
+        ev_src_t *sub = m_itr_get(m_itr);
+        m_mod_t *mod = sub->mod;
+        if (mod->ps_stamp != stamp && m_mod_is(mod, M_MOD_RUNNING | M_MOD_PAUSED)) {
+            mod->ps_stamp = stamp;
+            tell_if(msg, (char *)sub, mod);
+        }
+    });
+    
+    /* Modules with a subscription regex matching topic */
+    m_itr_foreach(idx->regexes, {
+        ev_src_t *sub = m_itr_get(m_itr);
+        m_mod_t *mod = sub->mod;
+        if (mod->ps_stamp != stamp && m_mod_is(mod, M_MOD_RUNNING | M_MOD_PAUSED) &&
+            regexec(&sub->ps_src.reg, msg->msg.topic, 0, NULL, 0) == 0) {
+            
+            mod->ps_stamp = stamp;
             tell_if(msg, (char *)sub, mod);
         }
     });
@@ -118,7 +234,7 @@ static void tell_subscribers(void *data, void *value) {
 
 static int tell_pubsub_msg(ps_priv_t *m, const m_mod_t *recipient, m_ctx_t *c) {
     if (recipient) { // it is a direct tell
-        tell_if(m, NULL, (m_mod_t *)recipient);
+        return tell_mod(m, NULL, (m_mod_t *)recipient);
     } else {
         /* Broadcast messages */
         if (!m->msg.topic) {
@@ -130,29 +246,146 @@ static int tell_pubsub_msg(ps_priv_t *m, const m_mod_t *recipient, m_ctx_t *c) {
     return 0;
 }
 
-static int send_msg(m_mod_t *mod, const m_mod_t *recipient, const char *topic, 
-                    const void *message, m_ps_flags flags) {
+static int send_msg(m_mod_t *mod, const m_mod_t *recipient, const char *topic, m_ps_topic_t topic_id,
+                    const void *message, m_ps_flags flags, ask_t *ask) {
     M_PARAM_ASSERT(message);
+    M_PARAM_ASSERT(!((flags & M_PS_AUTOFREE) && (flags & M_PS_MEMREF)));
 
+    ps_priv_t *m = alloc_ps_msg(false, mod, topic, topic_id, message, flags);
+    M_ALLOC_ASSERT(m);
+    if (ask) {
+        m->msg.ask = true;
+        m->ask = m_mem_ref(ask);
+    }
+    
     mod->stats.sent_msgs++;
-    ps_priv_t m = { { false, mod, topic, message }, flags, NULL };
-    return tell_pubsub_msg(&m, recipient, mod->ctx);
+    int ret;
+    if (recipient && recipient->ctx != mod->ctx) {
+        /* Recipient lives in another ctx, ie: in another thread: send message to its inbox */
+        ret = inbox_push(recipient->ctx, m, (m_mod_t *)recipient);
+    } else {
+        ret = tell_pubsub_msg(m, recipient, mod->ctx);
+        if (ret == 0 && !recipient && (flags & M_PS_GLOBAL)) {
+            ret = ctx_publish_global(mod->ctx, m);
+        }
+    }
+    
+    /* Drop our reference: envelope will be destroyed by last recipient */
+    m_mem_unref(m);
+    return ret;
+}
+
+/*
+ * Tell a reply to its requester; this is always called by requester ctx thread.
+ * Only first reply is told: late ones (eg: received after a timeout) are discarded.
+ */
+static int tell_reply(m_ctx_t *c, ps_priv_t *env) {
+    ask_t *ask = env->reply_to;
+    if (ask->done) {
+        M_DEBUG("Discarding late reply for '%s'.\n", ask->requester->name);
+        return 0;
+    }
+    
+    /* If requester mailbox is full, request stays pending: requester will be told a timeout */
+    int ret = tell_mod(env, NULL, ask->requester);
+    if (ret == 0) {
+        ask_done(c, ask);
+    }
+    return ret;
+}
+
+/*
+ * Replies and timeouts are received as M_SRC_TYPE_ASK events;
+ * the event owns the request, that in turn owns reply envelope (and thus reply data).
+ */
+static evt_priv_t *new_ask_evt(mbox_msg_t *m) {
+    ps_priv_t *env = m->env;
+    evt_priv_t *evt = new_evt(NULL);
+    if (evt) {
+        ask_t *ask = env->reply_to;
+        env->reply_to = NULL;                   // evt_dtor() will drop request ref
+        ask->reply = env;                       // request dtor will drop envelope ref
+        ask->evt.timedout = env->msg.sender == NULL;
+        ask->evt.responder = env->msg.sender;
+        ask->evt.data = env->msg.data;
+        evt->evt.type = M_SRC_TYPE_ASK;
+        evt->evt.ask_evt = &ask->evt;
+        evt->evt.userdata = ask->userptr;
+    } else {
+        m_mem_unref(env);
+    }
+    m_mem_unref(m->sub);
+    return evt;
 }
 
 /** Private API **/
 
-int tell_system_pubsub_msg(const m_mod_t *recipient, m_ctx_t *c, m_mod_t *sender, const char *topic) {
+int tell_system_pubsub_msg(const m_mod_t *recipient, m_ctx_t *c, m_mod_t *sender, m_ps_topic_t topic) {
     if (sender) {
         // A module sent a M_PS_MOD_POISONPILL message to another, or it was stopped
         sender->stats.sent_msgs++;
     }
-    ps_priv_t m = { { true, sender, topic, NULL }, 0, NULL };
-    return tell_pubsub_msg(&m, recipient, c);
+    /* 
+     * System messages are routed through ctx subscriptions index too:
+     * when nobody is subscribed, do not even allocate the message.
+     */
+    if (!recipient && !has_subscribers(c, topic)) {
+        return 0;
+    }
+    
+    const char *name = topic_name(topic);
+    M_ALLOC_ASSERT(name);
+    
+    ps_priv_t *m = alloc_ps_msg(true, sender, name, topic, NULL, 0);
+    M_ALLOC_ASSERT(m);
+    
+    int ret = tell_pubsub_msg(m, recipient, c);
+    m_mem_unref(m);
+    return ret;
+}
+
+/* Tell a message sent by another ctx, received from ctx inbox */
+int tell_inbox_msg(m_ctx_t *c, ps_priv_t *env, m_mod_t *recipient) {
+    if (env->reply_to) {
+        return tell_reply(c, env);
+    }
+    return tell_pubsub_msg(env, recipient, c);
+}
+
+/* Tell a timeout to the requester of an expired request, through a sender-less envelope */
+int tell_ask_timeout(ask_t *ask) {
+    ps_priv_t *m = alloc_ps_msg(true, NULL, NULL, M_PS_TOPIC_NONE, NULL, 0);
+    M_ALLOC_ASSERT(m);
+    
+    m->reply_to = m_mem_ref(ask);
+    int ret = tell_mod(m, NULL, ask->requester);
+    m_mem_unref(m);
+    return ret;
+}
+
+/*
+ * Create an event for a message fetched from a mailbox,
+ * moving to it the references held by the mailbox record.
+ */
+evt_priv_t *new_ps_evt(mbox_msg_t *m) {
+    if (m->env->reply_to) {
+        return new_ask_evt(m);
+    }
+    
+    evt_priv_t *evt = new_evt(m->sub);
+    if (evt) {
+        evt->evt.ps_evt = &m->env->msg; // evt_dtor() will drop envelope ref
+    } else {
+        m_mem_unref(m->env);
+    }
+    m_mem_unref(m->sub);
+    return evt;
 }
 
 int flush_pubsub_msgs(void *data, const char *key, void *value) {
     m_mod_t *mod = (m_mod_t *)value;
-    ps_priv_t *mm = NULL;
+    mbox_msg_t msgs[M_PS_MAX_DRAIN];
+    ssize_t len;
 
     const bool stopping_mod = key == NULL;
     
@@ -161,24 +394,26 @@ int flush_pubsub_msgs(void *data, const char *key, void *value) {
         M_WARN("Failed to create flushing queue.\n");
     }
 
-    while (mod->pubsub_fd[0] != -1 &&
-        read(mod->pubsub_fd[0], &mm, sizeof(ps_priv_t *)) == sizeof(ps_priv_t *)) {
-        /*
-         * Actually tell msg ONLY if we are not stopping the module,
-         * ie: we are stopping looping on the context.
-         * Else, just free msg.
-         */
-        if (!stopping_mod && m_mod_is(mod, M_MOD_RUNNING)) {
-            M_DEBUG("Flushing enqueued pubsub message for module '%s'.\n", mod->name);
-            evt_priv_t *msg = new_evt(mm->sub);
-            if (msg && flushed) {
-                msg->evt.ps_evt = &mm->msg;
-                m_queue_enqueue(flushed, msg);
+    while ((len = mbox_drain(mod, msgs, M_PS_MAX_DRAIN)) > 0) {
+        for (ssize_t i = 0; i < len; i++) {
+            mbox_msg_t *mm = &msgs[i];
+            /*
+             * Actually tell msg ONLY if we are not stopping the module,
+             * ie: we are stopping looping on the context.
+             * Else, just free msg.
+             */
+            if (!stopping_mod && m_mod_is(mod, M_MOD_RUNNING) && flushed) {
+                M_DEBUG("Flushing enqueued pubsub message for module '%s'.\n", mod->name);
+                evt_priv_t *msg = new_ps_evt(mm);
+                if (msg) {
+                    m_queue_enqueue(flushed, msg);
+                }
                 continue;
             }
+            M_DEBUG("Destroying enqueued pubsub message for module '%s'.\n", mod->name);
+            m_mem_unref(mm->env);
+            m_mem_unref(mm->sub);
         }
-        M_DEBUG("Destroying enqueued pubsub message for module '%s'.\n", mod->name);
-        m_mem_unref(mm);
     }
     call_pubsub_cb(mod, flushed);
     
@@ -233,15 +468,26 @@ _public_ int m_mod_ps_subscribe(m_mod_t *mod, const char *topic, m_src_flags fla
     M_SRC_ASSERT_PRIO_FLAGS();
     M_MOD_CONSUME_TOKEN(mod);
 
-    /* Check if it is a valid regex: compile it */
+    /* Literal topics never reach the regex engine; otherwise check if it is a valid regex: compile it */
     regex_t regex;
-    int ret = regcomp(&regex, topic, REG_NOSUB);
+    const bool literal = is_literal_topic(topic);
+    int ret = literal ? 0 : regcomp(&regex, topic, REG_NOSUB);
     if (ret == 0) {
-        M_DEBUG("'%s' is a valid regex.\n", topic);
+        M_DEBUG("'%s' is a valid %s.\n", topic, literal ? "literal topic" : "regex");
+        
+        /* Subscriptions are indexed by interned topic; interned name is stable, thus it is never duplicated */
+        const m_ps_topic_t id = m_ps_topic_intern(topic);
+        if (id == M_PS_TOPIC_NONE) {
+            if (!literal) {
+                regfree(&regex);
+            }
+            return -ENOMEM;
+        }
+        topic = topic_name(id);
         
         /* Lazy subscriptions map init */
         if (!mod->subscriptions)  {
-            mod->subscriptions = m_map_new(M_MAP_VAL_ALLOW_UPDATE, mem_dtor);
+            mod->subscriptions = m_map_new(M_MAP_VAL_ALLOW_UPDATE, unsubscribe_dtor);
             M_ALLOC_ASSERT(mod->subscriptions);
         } else {
             ev_src_t *old_sub = m_map_get(mod->subscriptions, topic);
@@ -249,6 +495,9 @@ _public_ int m_mod_ps_subscribe(m_mod_t *mod, const char *topic, m_src_flags fla
                 if (old_sub->flags == flags) {
                     /* Only update userptr */
                     old_sub->userptr = userptr;
+                    if (!literal) {
+                        regfree(&regex);
+                    }
                     return 0;
                 }
             }
@@ -263,9 +512,23 @@ _public_ int m_mod_ps_subscribe(m_mod_t *mod, const char *topic, m_src_flags fla
         sub->flags = flags;
         sub->userptr = userptr;
         sub->mod = mod;
-        memcpy(&ps_src->reg, &regex, sizeof(regex_t));
-        ps_src->topic = sub->flags & M_SRC_DUP ? mem_strdup(topic) : topic;
+        ps_src->literal = literal;
+        if (!literal) {
+            memcpy(&ps_src->reg, &regex, sizeof(regex_t));
+        }
+        ps_src->topic = topic;
+        ps_src->topic_id = id;
         ret = m_map_put(mod->subscriptions, ps_src->topic, sub); // M_MAP_VAL_ALLOW_UPDATE -> this will dtor old elem before updating
+        if (ret == 0) {
+            ret = index_sub(mod->ctx, sub);
+            if (ret != 0) {
+                m_map_remove(mod->subscriptions, ps_src->topic);
+            }
+        } else {
+            /* userptr is still owned by caller */
+            sub->flags &= ~M_SRC_AUTOFREE;
+            m_mem_unref(sub);
+        }
     }
     return ret;
 }
@@ -287,11 +550,61 @@ _public_ int m_mod_ps_unsubscribe(m_mod_t *mod, const char *topic) {
 _public_ int m_mod_ps_tell(m_mod_t *mod, const m_mod_t *recipient, const void *message, m_ps_flags flags) {
     M_MOD_ASSERT_PERM(mod, M_MOD_DENY_PUB);
     M_PARAM_ASSERT(recipient);
-    /* only same ctx modules can talk */
-    M_PARAM_ASSERT(mod->ctx == recipient->ctx);
+    /* Recipient may live in another ctx: message will then be sent to its ctx inbox */
     M_MOD_CONSUME_TOKEN(mod);
 
-    return send_msg(mod, recipient, NULL, message, flags);
+    return send_msg(mod, recipient, NULL, M_PS_TOPIC_NONE, message, flags, NULL);
+}
+
+/*
+ * Send a request to recipient: its reply, or a timeout if no reply
+ * is received within timeout_ns, will be received as a M_SRC_TYPE_ASK event.
+ * Message data is owned by caller, as for m_mod_ps_tell() without flags.
+ */
+_public_ int m_mod_ps_ask(m_mod_t *mod, const m_mod_t *recipient, const void *message, uint64_t timeout_ns, const void *userptr) {
+    M_MOD_ASSERT_PERM(mod, M_MOD_DENY_PUB);
+    M_PARAM_ASSERT(recipient);
+    M_PARAM_ASSERT(timeout_ns > 0);
+    M_MOD_CONSUME_TOKEN(mod);
+    
+    ask_t *ask = ask_new(mod, timeout_ns, userptr);
+    M_ALLOC_ASSERT(ask);
+    
+    int ret = ask_track(mod->ctx, ask);
+    if (ret == 0) {
+        ret = send_msg(mod, recipient, NULL, M_PS_TOPIC_NONE, message, 0, ask);
+        if (ret != 0) {
+            ask_done(mod->ctx, ask);
+        }
+    }
+    m_mem_unref(ask);
+    return ret;
+}
+
+/* Reply to a request received from m_mod_ps_ask(); requester may live in another ctx */
+_public_ int m_mod_ps_reply(m_mod_t *mod, const m_evt_ps_t *request, const void *message, m_ps_flags flags) {
+    M_MOD_ASSERT_PERM(mod, M_MOD_DENY_PUB);
+    M_PARAM_ASSERT(request && request->ask);
+    M_PARAM_ASSERT(message);
+    M_PARAM_ASSERT(!(flags & M_PS_GLOBAL));
+    M_PARAM_ASSERT(!((flags & M_PS_AUTOFREE) && (flags & M_PS_MEMREF)));
+    M_MOD_CONSUME_TOKEN(mod);
+    
+    /* request is the first member of its envelope */
+    ask_t *ask = ((const ps_priv_t *)request)->ask;
+    ps_priv_t *m = alloc_ps_msg(false, mod, NULL, M_PS_TOPIC_NONE, message, flags);
+    M_ALLOC_ASSERT(m);
+    m->reply_to = m_mem_ref(ask);
+    
+    mod->stats.sent_msgs++;
+    int ret;
+    if (ask->requester->ctx != mod->ctx) {
+        ret = inbox_push(ask->requester->ctx, m, ask->requester);
+    } else {
+        ret = tell_reply(mod->ctx, m);
+    }
+    m_mem_unref(m);
+    return ret;
 }
 
 _public_ int m_mod_ps_publish(m_mod_t *mod, const char *topic, const void *message, m_ps_flags flags) {
@@ -299,7 +612,33 @@ _public_ int m_mod_ps_publish(m_mod_t *mod, const char *topic, const void *messa
     M_RET_ASSERT(!is_system_message(topic), -EPERM);
     M_MOD_CONSUME_TOKEN(mod);
     
-    return send_msg(mod, NULL, topic, message, flags);
+    /* Compatibility layer: topic is routed by its interned id, if any (ie: if someone subscribed to it) */
+    const m_ps_topic_t id = topic ? topic_lookup(topic) : M_PS_TOPIC_NONE;
+    return send_msg(mod, NULL, id != M_PS_TOPIC_NONE ? topic_name(id) : topic, id, message, flags, NULL);
+}
+
+_public_ int m_mod_ps_publish_topic(m_mod_t *mod, m_ps_topic_t topic, const void *message, m_ps_flags flags) {
+    M_MOD_ASSERT_PERM(mod, M_MOD_DENY_PUB);
+    const char *name = topic_name(topic);
+    M_PARAM_ASSERT(name);
+    M_RET_ASSERT(!topic_is_system(topic), -EPERM);
+    M_MOD_CONSUME_TOKEN(mod);
+    
+    return send_msg(mod, NULL, name, topic, message, flags, NULL);
+}
+
+_public_ int m_mod_ps_subscribe_topic(m_mod_t *mod, m_ps_topic_t topic, m_src_flags flags, const void *userptr) {
+    const char *name = topic_name(topic);
+    M_PARAM_ASSERT(name);
+    
+    return m_mod_ps_subscribe(mod, name, flags, userptr);
+}
+
+_public_ int m_mod_ps_unsubscribe_topic(m_mod_t *mod, m_ps_topic_t topic) {
+    const char *name = topic_name(topic);
+    M_PARAM_ASSERT(name);
+    
+    return m_mod_ps_unsubscribe(mod, name);
 }
 
 _public_ int m_mod_ps_poisonpill(m_mod_t *mod, const m_mod_t *recipient) {
@@ -310,5 +649,5 @@ _public_ int m_mod_ps_poisonpill(m_mod_t *mod, const m_mod_t *recipient) {
     M_PARAM_ASSERT(m_mod_is(recipient, M_MOD_RUNNING));
     M_MOD_CONSUME_TOKEN(mod);
 
-    return tell_system_pubsub_msg(recipient, mod->ctx, mod, M_PS_MOD_POISONPILL);
+    return tell_system_pubsub_msg(recipient, mod->ctx, mod, M_PS_TOPIC_MOD_POISONPILL);
 }
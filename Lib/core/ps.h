@@ -1,9 +1,15 @@
 #pragma once
 
-#include "mod.h"
+#include "src.h"
+#include "topic.h"
+#include "ask.h"
 
-#define M_PS_MOD_POISONPILL     "LIBMODULE_MOD_POISONPILL"
+#define M_PS_MAX_DRAIN          128     // Max number of pubsub messages fetched from a mailbox at once
+#define M_PS_IDX_MIN_LEN        64      // Initial number of slots of ctx subscriptions index
 
-int tell_system_pubsub_msg(const m_mod_t *recipient, m_ctx_t *c, m_mod_t *sender, const char *topic);
+int tell_system_pubsub_msg(const m_mod_t *recipient, m_ctx_t *c, m_mod_t *sender, m_ps_topic_t topic);
 int flush_pubsub_msgs(void *data, const char *key, void *value);
+int tell_inbox_msg(m_ctx_t *c, ps_priv_t *env, m_mod_t *recipient);
+int tell_ask_timeout(ask_t *ask);
+evt_priv_t *new_ps_evt(mbox_msg_t *m);
 void call_pubsub_cb(m_mod_t *mod, m_queue_t *evts);
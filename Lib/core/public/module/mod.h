@@ -18,6 +18,7 @@ typedef enum {
     M_SRC_TYPE_PID,   // PID Source
     M_SRC_TYPE_TASK,  // Task source -> M_SRC_ONESHOT flag is implicit
     M_SRC_TYPE_THRESH,// Threshold source -> M_SRC_ONESHOT flag is implicit
+    M_SRC_TYPE_ASK,   // Reply to a m_mod_ps_ask() request, or its timeout; not a registrable source
     M_SRC_TYPE_END    // End of supported sources
 } m_src_types;
 
@@ -33,8 +34,9 @@ typedef enum {
     M_SRC_PRIO_HIGH       =       1 << 2, // PubSub subscription high priority
     M_SRC_AUTOFREE        =       1 << 3, // Automatically free userdata upon source deregistation.
     M_SRC_ONESHOT         =       1 << 4, // Run just once then automatically deregister source.
-    M_SRC_DUP             =       1 << 5, // Duplicate PubSub topic, source fd or source path.
+    M_SRC_DUP             =       1 << 5, // Duplicate source fd or source path. PubSub topics are always interned, thus never duplicated.
     M_SRC_FD_AUTOCLOSE    =       M_SRC_SHIFT(M_SRC_TYPE_FD, 1 << 0), // Automatically close fd upon deregistation.
+    M_SRC_PS_CONFLATE     =       M_SRC_SHIFT(M_SRC_TYPE_PS, 1 << 0), // Last-value subscription: a newer message replaces the undelivered one in place
     M_SRC_TMR_ABSOLUTE    =       M_SRC_SHIFT(M_SRC_TYPE_TMR, 1 << 0), // Absolute timer
 } m_src_flags;
 
@@ -45,11 +47,18 @@ typedef enum {
 #define M_PS_MOD_STARTED    "LIBMODULE_MOD_STARTED"
 #define M_PS_MOD_STOPPED    "LIBMODULE_MOD_STOPPED"
 
+/* Interned topic handle, returned by m_ps_topic_intern() */
+typedef uint32_t m_ps_topic_t;
+
+#define M_PS_TOPIC_NONE     0       // Invalid topic handle
+
 /*
  * Module's pubsub API flags (m_mod_tell(), m_mod_publish(), m_mod_broadcast())
  */
 typedef enum {
     M_PS_AUTOFREE   = 1 << 0,     // Autofree PubSub data after every recipient receives message (ie: when ps_evt ref counter goes to 0)
+    M_PS_GLOBAL     = 1 << 1,     // Publish/broadcast message to modules of every registered context, ie: of every thread
+    M_PS_MEMREF     = 1 << 2,     // PubSub data is a ref counted memory area (m_mem_new(), m_mem_pool_alloc()): it is ref'd until every recipient receives message, without any copy
 } m_ps_flags;
 
 /** Libmodule input src types for m_mod_src_register() API **/
@@ -90,9 +99,18 @@ typedef struct {
     bool system;            // Is this a system message?
     const m_mod_t *sender;
     const char *topic;
+    m_ps_topic_t topic_id;  // Interned topic handle; M_PS_TOPIC_NONE for direct tells, broadcasts and never interned topics
     const void *data;       // NULL for system messages
+    bool ask;               // Whether sender is waiting for an answer: use m_mod_ps_reply()
 } m_evt_ps_t;
 
+/* Ask messages: reply to a m_mod_ps_ask() request, or its timeout */
+typedef struct {
+    bool timedout;              // No reply was received before timeout
+    const m_mod_t *responder;   // NULL on timeout
+    const void *data;           // Reply data; NULL on timeout
+} m_evt_ask_t;
+
 /* Generic fd event messages */
 typedef struct {
     int fd;
@@ -145,8 +163,9 @@ typedef struct {
         m_evt_pid_t     *pid_evt;
         m_evt_task_t    *task_evt;
         m_evt_thresh_t  *thresh_evt;
+        m_evt_ask_t     *ask_evt;
     };
-    const void *userdata;                           // Event userdata, passed through m_mod_src_register()
+    const void *userdata;                           // Event userdata, passed through m_mod_src_register() or m_mod_ps_ask()
     uint64_t ts;                                    // Event timestamp
 } m_evt_t;
 
@@ -159,6 +178,14 @@ typedef enum {
     M_MOD_ZOMBIE = 1 << 4
 } m_mod_states;
 
+/* Modules mailbox overflow policies, ie: what happens when a message is told to a full mailbox */
+typedef enum {
+    M_MOD_MBOX_REJECT,              // Message is dropped and sender gets -EAGAIN (default)
+    M_MOD_MBOX_DROP_OLDEST,         // Oldest pending message of the lowest priority is dropped to make room for the new one
+    M_MOD_MBOX_DROP_NEWEST,         // Message is silently dropped
+    M_MOD_MBOX_BLOCK                // Senders from another context block until there is room; same context senders behave as M_MOD_MBOX_REJECT
+} m_mod_mbox_policy;
+
 /*
  * Modules flags, leave upper 16b for module permissions management;
  * First 8 bits are constant flags.
@@ -173,7 +200,7 @@ typedef enum {
     M_MOD_PERSIST           = M_MOD_FL_MODIFIABLE(1 << 1),         // Module cannot be deregistered by direct call to m_mod_deregister (or by FS delete) while its context is looping
     M_MOD_USERDATA_AUTOFREE = M_MOD_FL_MODIFIABLE(1 << 2),         // Automatically free module userdata upon deregister
     M_MOD_DENY_CTX          = M_MOD_FL_PERM(1 << 0), // Deny access to module's ctx through m_mod_ctx() (it means the module won't be able to call ctx API)
-    M_MOD_DENY_PUB          = M_MOD_FL_PERM(1 << 1), // Deny access to module's publishing functions: m_mod_ps_{tell,publish,broadcast,poisonpill}
+    M_MOD_DENY_PUB          = M_MOD_FL_PERM(1 << 1), // Deny access to module's publishing functions: m_mod_ps_{tell,publish,broadcast,poisonpill,ask,reply}
     M_MOD_DENY_SUB          = M_MOD_FL_PERM(1 << 2), // Deny access to m_mod_ps_(un)subscribe()
 } m_mod_flags;
 
@@ -196,6 +223,9 @@ typedef struct {
     double activity_freq;
     uint64_t sent_msgs;
     uint64_t recv_msgs;
+    uint64_t dropped_msgs;          // Messages dropped because mailbox was full
+    size_t mbox_high_watermark;     // Max number of pending messages ever reached by mailbox
+    uint64_t conflated_msgs;        // Messages replaced by a newer one before delivery (M_SRC_PS_CONFLATE)
 } m_mod_stats_t;
 
 /* Module interface functions */
@@ -239,6 +269,17 @@ int m_mod_ps_poisonpill(m_mod_t *mod, const m_mod_t *recipient);
 int m_mod_ps_subscribe(m_mod_t *mod, const char *topic, m_src_flags flags, const void *userptr);
 int m_mod_ps_unsubscribe(m_mod_t *mod, const char *topic);
 
+/* Request/reply: reply (or timeout) is received as a M_SRC_TYPE_ASK event, whose userdata is userptr */
+int m_mod_ps_ask(m_mod_t *mod, const m_mod_t *recipient, const void *message, uint64_t timeout_ns, const void *userptr);
+int m_mod_ps_reply(m_mod_t *mod, const m_evt_ps_t *request, const void *message, m_ps_flags flags);
+
+/* Interned topics: faster routing, as published messages are matched by handle instead of by name */
+m_ps_topic_t m_ps_topic_intern(const char *name);
+const char *m_ps_topic_name(m_ps_topic_t topic);
+int m_mod_ps_publish_topic(m_mod_t *mod, m_ps_topic_t topic, const void *message, m_ps_flags flags);
+int m_mod_ps_subscribe_topic(m_mod_t *mod, m_ps_topic_t topic, m_src_flags flags, const void *userptr);
+int m_mod_ps_unsubscribe_topic(m_mod_t *mod, m_ps_topic_t topic);
+
 /* Events' stashing API */
 int m_mod_stash(m_mod_t *mod, const m_evt_t *evt);
 ssize_t m_mod_unstash(m_mod_t *mod, size_t len);
@@ -274,6 +315,9 @@ int m_mod_set_batch_timeout(m_mod_t *mod, uint64_t timeout_ns);
 /* Mod tokenbucket */
 int m_mod_set_tokenbucket(m_mod_t *mod, uint32_t rate, uint64_t burst);
 
+/* Mod mailbox */
+int m_mod_set_mailbox(m_mod_t *mod, size_t len, m_mod_mbox_policy policy);
+
 /* Generic event source registering functions */
 #define m_mod_src_register(mod, X, flags, userptr) _Generic((X) + 0, \
     int: m_mod_src_register_fd, \
@@ -23,7 +23,6 @@ static int taskcmp(void *my_data, void *node_data);
 static int threshcmp(void *my_data, void *node_data);
 
 /* Process functions */
-static ev_src_t *process_ps(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt);
 static ev_src_t *process_fd(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt);
 static ev_src_t *process_tmr(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt);
 static ev_src_t *process_sgn(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt);
@@ -33,7 +32,7 @@ static ev_src_t *process_task(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *e
 static ev_src_t *process_thresh(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt);
 
 static m_bst_cmp src_cmp_map[] = {
-        fdcmp,      // M_SRC_TYPE_PS we use internal pipe fd used for pubsub as module PS source
+        NULL,       // M_SRC_TYPE_PS subscriptions are stored in mod->subscriptions map
         fdcmp,      // M_SRC_TYPE_FD
         tmrcmp,     // M_SRC_TYPE_TMR
         sgncmp,     // M_SRC_TYPE_SGN
@@ -41,6 +40,7 @@ static m_bst_cmp src_cmp_map[] = {
         pidcmp,     // M_SRC_TYPE_PID
         taskcmp,    // M_SRC_TYPE_TASK
         threshcmp,  // M_SRC_TYPE_THRESH
+        NULL,       // M_SRC_TYPE_ASK replies are not registered sources
 };
 _Static_assert(sizeof(src_cmp_map) / sizeof(*src_cmp_map) == M_SRC_TYPE_END, "Undefined source compare function.");
 
@@ -53,11 +53,12 @@ const char *src_names[] = {
         "Pids",     // M_SRC_TYPE_PID
         "Tasks",    // M_SRC_TYPE_TASK
         "Thresh",   // M_SRC_TYPE_THRESH
+        "Asks",     // M_SRC_TYPE_ASK
 };
 _Static_assert(sizeof(src_names) / sizeof(*src_names) == M_SRC_TYPE_END, "Undefined source name.");
 
 static process_cb src_procs_map[] = {
-    process_ps,      // M_SRC_TYPE_PS we use internal pipe fd used for pubsub as module PS source
+    NULL,            // M_SRC_TYPE_PS messages are delivered through module mailbox
     process_fd,      // M_SRC_TYPE_FD
     process_tmr,     // M_SRC_TYPE_TMR
     process_sgn,     // M_SRC_TYPE_SGN
@@ -65,6 +66,7 @@ static process_cb src_procs_map[] = {
     process_pid,     // M_SRC_TYPE_PID
     process_task,    // M_SRC_TYPE_TASK
     process_thresh,  // M_SRC_TYPE_THRESH
+    NULL,            // M_SRC_TYPE_ASK replies are delivered through module mailbox
 };
 _Static_assert(sizeof(src_procs_map) / sizeof(*src_procs_map) == M_SRC_TYPE_END, "Undefined source processor function.");
 
@@ -81,7 +83,6 @@ static void src_priv_dtor(void *data) {
     if (t->flags & M_SRC_FD_AUTOCLOSE) {
         int fd = -1;
         switch (t->type) {
-            case M_SRC_TYPE_PS: // M_SRC_TYPE_PS is used for pubsub_fd[0] in init_pubsub_fd()
             case M_SRC_TYPE_FD:
                 fd = t->fd_src.fd;
                 break;
@@ -139,7 +140,6 @@ static ev_src_t *create_src(m_mod_t *mod, m_src_types type, process_cb proc,
     src->fd_src.fd = -1;
     
     switch (type) {
-        case M_SRC_TYPE_PS: // M_SRC_TYPE_PS is used for pubsub_fd[0] in init_pubsub_fd()
         case M_SRC_TYPE_FD: {
             fd_src_t *fd_src = &src->fd_src;
             int fd = *((int *)src_data);
@@ -252,24 +252,6 @@ static int threshcmp(void *my_data, void *node_data) {
     return my_val - their_val;
 }
 
-static ev_src_t *process_ps(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt) {
-    ps_priv_t *ps_msg;
-    /* Received on pubsub interface */
-    if (read(this->fd_src.fd, (void **)&ps_msg, sizeof(ps_priv_t *)) != sizeof(ps_priv_t *)) {
-        M_ERR("Failed to read message: %s\n", strerror(errno));
-    } else {
-        /*
-         * Use real event source, ie: topic subscription, being careful to unref current src;
-         * Note: it can be NULL when the ps message was created by a direct tell() or broadcast()
-         */
-        evt->evt.ps_evt = &ps_msg->msg;
-        m_mem_unref(this);
-        this = m_mem_ref(ps_msg->sub);
-        evt->src = this;
-    }
-    return this;
-}
-
 static ev_src_t *process_fd(ev_src_t *this, m_ctx_t *c, int idx, evt_priv_t *evt) {
     evt->evt.fd_evt = m_mem_new(sizeof(*evt->evt.fd_evt), NULL);
     evt->evt.fd_evt->fd = this->fd_src.fd;
@@ -13,6 +13,9 @@
 /* Forward declare evt_priv_t to avoid dep cycle */
 typedef struct _ev_priv evt_priv_t;
 
+/* Forward declare ask_t to avoid dep cycle */
+typedef struct _ask ask_t;
+
 /* Struct that holds fds to self_t mapping for poll plugin */
 typedef struct {
     int fd;
@@ -70,7 +73,10 @@ typedef struct {
 /* Struct that holds pubsub subscriptions source data */
 typedef struct {
     regex_t reg;
-    const char *topic;
+    const char *topic;      // Interned topic name
+    m_ps_topic_t topic_id;
+    bool literal;           // Topic has no regex metachar: it is only matched by exact comparison, and reg is unused
+    mbox_msg_t *pending;    // Mailbox slot of the undelivered message, for M_SRC_PS_CONFLATE subscriptions
 } ps_src_t;
 
 typedef struct _ev_src *(*process_cb)(struct _ev_src *this, m_ctx_t *c, int idx, evt_priv_t *evt);
@@ -95,11 +101,15 @@ typedef struct _ev_src {
     process_cb process; // Processors can update the src, that's why they return an ev_src_t (PS only)
 } ev_src_t;
 
-/* Struct that holds pubsub messaging, private */
-typedef struct {
+/* 
+ * Struct that holds pubsub messaging, private.
+ * It is a refcounted envelope shared by all message recipients.
+ */
+typedef struct _ps_priv {
     m_evt_ps_t msg;
     m_ps_flags flags;
-    ev_src_t *sub;
+    ask_t *ask;                             // Ref to pending request, for m_mod_ps_ask() messages
+    ask_t *reply_to;                        // Ref to answered request, for replies and timeouts
 } ps_priv_t;
 
 extern const char *src_names[];
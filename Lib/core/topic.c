@@ -0,0 +1,129 @@
+#include "topic.h"
+#include <pthread.h>
+
+/*****************************************
+ * Code related to topics interning.     *
+ *****************************************/
+
+/* An interned topic */
+typedef struct {
+    const char *name;                                           // Interned topic name, never freed
+    bool system;                                                // Whether it is a system topic, ie: users cannot publish on it
+} topic_t;
+
+/*
+ * Topics are interned process-wide, as messages can be published to every ctx (M_PS_GLOBAL);
+ * ids are stable for the process lifetime.
+ * Table is made of fixed size chunks that are never moved,
+ * so that id -> topic lookups do not need any lock.
+ */
+static pthread_once_t topics_once = PTHREAD_ONCE_INIT;
+static pthread_rwlock_t topics_mx = PTHREAD_RWLOCK_INITIALIZER;       // Protects name -> id map and topics insertion
+static m_map_t *topic_ids;                                            // Map of topics name -> id
+static topic_t *topics[M_PS_TOPIC_MAX_CHUNKS];                        // Chunked id -> topic table
+static m_ps_topic_t topics_len = 1;                                   // Next free id; id 0 is never used
+
+static void topics_init(void);
+static m_ps_topic_t topic_find(const char *name);
+static m_ps_topic_t topic_add(const char *name);
+static const topic_t *topic_get(m_ps_topic_t id);
+
+static void topics_init(void) {
+    static const char *const system_topics[] = {
+        M_PS_CTX_STARTED, M_PS_CTX_STOPPED, M_PS_CTX_TICK,
+        M_PS_MOD_STARTED, M_PS_MOD_STOPPED, M_PS_MOD_POISONPILL
+    };
+    
+    topic_ids = m_map_new(0, NULL);
+    if (topic_ids) {
+        for (int i = 0; i < sizeof(system_topics) / sizeof(*system_topics); i++) {
+            topic_add(system_topics[i]);
+        }
+    }
+}
+
+/* Called with topics_mx held */
+static m_ps_topic_t topic_find(const char *name) {
+    return (m_ps_topic_t)(uintptr_t)m_map_get(topic_ids, name);
+}
+
+/* Called with topics_mx held for writing */
+static m_ps_topic_t topic_add(const char *name) {
+    const m_ps_topic_t id = topics_len;
+    const size_t chunk = id / M_PS_TOPIC_CHUNK_LEN;
+    M_RET_ASSERT(chunk < M_PS_TOPIC_MAX_CHUNKS, M_PS_TOPIC_NONE);
+    
+    if (!topics[chunk]) {
+        topic_t *t = memhook._calloc(M_PS_TOPIC_CHUNK_LEN, sizeof(topic_t));
+        M_RET_ASSERT(t, M_PS_TOPIC_NONE);
+        __atomic_store_n(&topics[chunk], t, __ATOMIC_RELEASE);
+    }
+    
+    char *dup = mem_strdup(name);
+    M_RET_ASSERT(dup, M_PS_TOPIC_NONE);
+    if (m_map_put(topic_ids, dup, (void *)(uintptr_t)id) != 0) {
+        memhook._free(dup);
+        return M_PS_TOPIC_NONE;
+    }
+    
+    topic_t *t = &topics[chunk][id % M_PS_TOPIC_CHUNK_LEN];
+    t->name = dup;
+    t->system = strncmp(name, "LIBMODULE_", strlen("LIBMODULE_")) == 0;
+    __atomic_store_n(&topics_len, id + 1, __ATOMIC_RELEASE);
+    return id;
+}
+
+static const topic_t *topic_get(m_ps_topic_t id) {
+    pthread_once(&topics_once, topics_init);
+    
+    if (id == M_PS_TOPIC_NONE || id >= __atomic_load_n(&topics_len, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    return &__atomic_load_n(&topics[id / M_PS_TOPIC_CHUNK_LEN], __ATOMIC_ACQUIRE)[id % M_PS_TOPIC_CHUNK_LEN];
+}
+
+/** Private API **/
+
+/* Find id of an already interned topic; M_PS_TOPIC_NONE if it was never interned */
+m_ps_topic_t topic_lookup(const char *name) {
+    pthread_once(&topics_once, topics_init);
+    
+    pthread_rwlock_rdlock(&topics_mx);
+    const m_ps_topic_t id = topic_ids ? topic_find(name) : M_PS_TOPIC_NONE;
+    pthread_rwlock_unlock(&topics_mx);
+    return id;
+}
+
+const char *topic_name(m_ps_topic_t id) {
+    const topic_t *t = topic_get(id);
+    return t ? t->name : NULL;
+}
+
+bool topic_is_system(m_ps_topic_t id) {
+    const topic_t *t = topic_get(id);
+    return t && t->system;
+}
+
+/** Public API **/
+
+_public_ m_ps_topic_t m_ps_topic_intern(const char *name) {
+    M_RET_ASSERT(name, M_PS_TOPIC_NONE);
+    
+    m_ps_topic_t id = topic_lookup(name);
+    if (id == M_PS_TOPIC_NONE) {
+        pthread_rwlock_wrlock(&topics_mx);
+        if (topic_ids) {
+            /* Someone else may have interned it in the meantime */
+            id = topic_find(name);
+            if (id == M_PS_TOPIC_NONE) {
+                id = topic_add(name);
+            }
+        }
+        pthread_rwlock_unlock(&topics_mx);
+    }
+    return id;
+}
+
+_public_ const char *m_ps_topic_name(m_ps_topic_t topic) {
+    return topic_name(topic);
+}
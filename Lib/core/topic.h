@@ -0,0 +1,27 @@
+#pragma once
+
+#include "globals.h"
+#include "public/module/mod.h"
+
+#define M_PS_MOD_POISONPILL     "LIBMODULE_MOD_POISONPILL"
+
+#define M_PS_TOPIC_CHUNK_LEN    1024    // Number of topics stored in each chunk of the topics table
+#define M_PS_TOPIC_MAX_CHUNKS   1024    // Max number of chunks, ie: max number of interned topics is 1M
+
+/*
+ * System topics are interned first, in this order;
+ * thus they have well known ids.
+ */
+enum {
+    M_PS_TOPIC_CTX_STARTED = 1,
+    M_PS_TOPIC_CTX_STOPPED,
+    M_PS_TOPIC_CTX_TICK,
+    M_PS_TOPIC_MOD_STARTED,
+    M_PS_TOPIC_MOD_STOPPED,
+    M_PS_TOPIC_MOD_POISONPILL,
+    M_PS_TOPIC_SYSTEM_MAX = M_PS_TOPIC_MOD_POISONPILL
+};
+
+m_ps_topic_t topic_lookup(const char *name);
+const char *topic_name(m_ps_topic_t id);
+bool topic_is_system(m_ps_topic_t id);
@@ -1,23 +1,25 @@
 #include "public/module/mem/mem.h"
 #include "log.h"
 #include "mem.h"
-#include <stdint.h>
+#include "mem_priv.h"
 #include <stddef.h>
 #include <stdalign.h>
 
 #define ALIGN_UP(x)             __ALIGN_MASK(x, (__typeof__(x))(alignof(max_align_t)) - 1)
 #define __ALIGN_MASK(x, mask)    (((x) + (mask)) &~ (mask))
 
-typedef struct {
-    size_t refs;        // Number of reference for this memory object
-    size_t size;        // size of user data, returned by m_mem_size()
-    m_ref_dtor dtor;    // Dtor for the memory object
-    uint8_t data[];     // Flexible array member for user data
-} mem_header_t;
+/** Private API **/
 
-static inline mem_header_t *get_header(uint8_t *src) {
-    const uint8_t align_shift = src[-1];
-    return (mem_header_t *)(src - sizeof(mem_header_t) - align_shift);
+/* Init the header of a memory object; user data starts align_shift bytes after header */
+void *mem_header_init(mem_header_t *header, uint8_t align_shift, size_t size, m_ref_dtor dtor, m_mem_pool_t *pool) {
+    header->refs = 1;
+    header->dtor = dtor;
+    header->size = size;
+    header->pool = pool;
+    uint8_t *data = header->data + align_shift;
+    /* Store alignment shift */
+    data[-1] = align_shift;
+    return data;
 }
 
 /** Public API **/
@@ -34,13 +36,7 @@ _public_ void *m_mem_new(size_t size, m_ref_dtor dtor) {
     }
     mem_header_t *header = memhook._calloc(1, total_size + align_shift);
     if (header) {
-        header->refs = 1;
-        header->dtor = dtor;
-        header->size = size;
-        uint8_t *data = header->data + align_shift;
-        /* Store alignment shift */
-        data[-1] = align_shift;
-        return data;
+        return mem_header_init(header, align_shift, size, dtor, NULL);
     }
     return NULL;
 }
@@ -48,8 +44,8 @@ _public_ void *m_mem_new(size_t size, m_ref_dtor dtor) {
 /* Gain a new ref on a memory area */
 _public_ void *m_mem_ref(void *src) {
     if (src) {
-        mem_header_t *header = get_header(src);
-        header->refs++;
+        mem_header_t *header = mem_get_header(src);
+        __atomic_add_fetch(&header->refs, 1, __ATOMIC_RELAXED);
     }
     return src;
 }
@@ -57,12 +53,16 @@ _public_ void *m_mem_ref(void *src) {
 /* Remove a ref from a memory area */
 _public_ void *m_mem_unref(void *src) {
     if (src) {
-        mem_header_t *header = get_header(src);
-        if (--header->refs == 0) {
+        mem_header_t *header = mem_get_header(src);
+        if (__atomic_sub_fetch(&header->refs, 1, __ATOMIC_ACQ_REL) == 0) {
             if (header->dtor) {
                 header->dtor(src); // destroy private data
             }
-            memhook._free(header);
+            if (header->pool) {
+                pool_release(header); // give memory back to its pool
+            } else {
+                memhook._free(header);
+            }
         }
     }
     return NULL;
@@ -76,7 +76,7 @@ _public_ void m_mem_unrefp(void **src) {
 
 _public_ size_t m_mem_size(void *src) {
     if (src) {
-        mem_header_t *header = get_header(src);
+        mem_header_t *header = mem_get_header(src);
         return header->size;
     }
     return 0;
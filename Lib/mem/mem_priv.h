@@ -0,0 +1,20 @@
+#pragma once
+
+#include "public/module/mem/pool.h"
+#include <stdint.h>
+
+typedef struct {
+    size_t refs;                // Number of reference for this memory object; atomically updated as objects can be shared between threads
+    size_t size;                // size of user data, returned by m_mem_size()
+    m_ref_dtor dtor;            // Dtor for the memory object
+    m_mem_pool_t *pool;         // Pool the memory object was taken from, if any
+    uint8_t data[];             // Flexible array member for user data
+} mem_header_t;
+
+static inline mem_header_t *mem_get_header(void *src) {
+    const uint8_t align_shift = ((uint8_t *)src)[-1];
+    return (mem_header_t *)((uint8_t *)src - sizeof(mem_header_t) - align_shift);
+}
+
+void *mem_header_init(mem_header_t *header, uint8_t align_shift, size_t size, m_ref_dtor dtor, m_mem_pool_t *pool);
+void pool_release(mem_header_t *header);
@@ -0,0 +1,277 @@
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE // memfd_create()
+#endif
+
+#include "mem_priv.h"
+#include "log.h"
+#include "mem.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define M_MEM_POOL_MIN_SHIFT    12      // Smallest size class: 4KB
+#define M_MEM_POOL_MAX_SHIFT    23      // Largest size class: 8MB, ie: it can hold a 4MB payload
+#define M_MEM_POOL_CLASSES      (M_MEM_POOL_MAX_SHIFT - M_MEM_POOL_MIN_SHIFT + 1)
+#define M_MEM_POOL_NO_CLASS     UINT8_MAX
+#define M_MEM_POOL_MAX_CACHED   16      // Max number of free buffers cached by each size class
+#define M_MEM_POOL_DATA_OFF     64      // Offset of user data from buffer start, ie: user data is cacheline aligned
+
+/*
+ * Pool buffer layout: [mem_header_t][pool_block_t][...][align shift][user data]
+ * pool_block_t lives in the padding between memory object header and user data.
+ */
+typedef struct {
+    size_t len;                 // Size of the whole buffer, header included
+    int fd;                     // Backing memfd, or -1 for heap buffers
+    uint8_t cls;                // Size class, or M_MEM_POOL_NO_CLASS for oversized buffers
+    bool sealed;                // Whether buffer was sealed, thus it can be shared with other processes
+} pool_block_t;
+
+/*
+ * A pool is itself a ref counted memory object:
+ * each outstanding buffer holds a reference to it,
+ * so that buffers can outlive m_mem_pool_free().
+ */
+struct _mem_pool {
+    pthread_mutex_t mx;                                 // Protects free lists; buffers may be released by any thread
+    mem_header_t *free[M_MEM_POOL_CLASSES];             // Cached free buffers, linked through their user data
+    size_t cached[M_MEM_POOL_CLASSES];                  // Number of cached free buffers for each size class
+    m_mem_pool_flags flags;
+    bool closed;                                        // Whether m_mem_pool_free() was called; released buffers are no more cached
+};
+
+_Static_assert(sizeof(mem_header_t) + sizeof(pool_block_t) < M_MEM_POOL_DATA_OFF, "Pool buffer header too big");
+
+static void pool_dtor(void *data);
+static inline pool_block_t *get_block(mem_header_t *header);
+static inline mem_header_t **free_link(mem_header_t *header);
+static inline uint8_t size_class(size_t len);
+static mem_header_t *block_new(const m_mem_pool_t *pool, size_t len, uint8_t cls);
+static void block_free(mem_header_t *header);
+static void pool_flush(m_mem_pool_t *pool);
+
+static void pool_dtor(void *data) {
+    m_mem_pool_t *pool = (m_mem_pool_t *)data;
+    pool_flush(pool);
+    pthread_mutex_destroy(&pool->mx);
+}
+
+static inline pool_block_t *get_block(mem_header_t *header) {
+    return (pool_block_t *)header->data;
+}
+
+/* Cached free buffers are linked through their user data */
+static inline mem_header_t **free_link(mem_header_t *header) {
+    return (mem_header_t **)((uint8_t *)header + M_MEM_POOL_DATA_OFF);
+}
+
+/* Smallest size class able to hold a buffer of len bytes */
+static inline uint8_t size_class(size_t len) {
+    uint8_t shift = M_MEM_POOL_MIN_SHIFT;
+    while (shift <= M_MEM_POOL_MAX_SHIFT && ((size_t)1 << shift) < len) {
+        shift++;
+    }
+    return shift <= M_MEM_POOL_MAX_SHIFT ? shift - M_MEM_POOL_MIN_SHIFT : M_MEM_POOL_NO_CLASS;
+}
+
+static mem_header_t *block_new(const m_mem_pool_t *pool, size_t len, uint8_t cls) {
+    mem_header_t *header = NULL;
+    int fd = -1;
+
+    if (pool->flags & M_MEM_POOL_MEMFD) {
+#ifdef MFD_ALLOW_SEALING
+        fd = memfd_create("libmodule_pool", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd == -1) {
+            return NULL;
+        }
+        if (ftruncate(fd, len) == 0) {
+            header = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (header == MAP_FAILED || !header) {
+            close(fd);
+            return NULL;
+        }
+#else
+        return NULL;
+#endif
+    } else {
+        header = memhook._malloc(len);
+        if (!header) {
+            return NULL;
+        }
+    }
+
+    pool_block_t *b = get_block(header);
+    b->len = len;
+    b->fd = fd;
+    b->cls = cls;
+    b->sealed = false;
+    return header;
+}
+
+static void block_free(mem_header_t *header) {
+    pool_block_t *b = get_block(header);
+    if (b->fd != -1) {
+        const int fd = b->fd;
+        munmap(header, b->len);
+        close(fd);
+    } else {
+        memhook._free(header);
+    }
+}
+
+/* Destroy all cached free buffers */
+static void pool_flush(m_mem_pool_t *pool) {
+    for (int i = 0; i < M_MEM_POOL_CLASSES; i++) {
+        mem_header_t *header = pool->free[i];
+        while (header) {
+            mem_header_t *next = *free_link(header);
+            block_free(header);
+            header = next;
+        }
+        pool->free[i] = NULL;
+        pool->cached[i] = 0;
+    }
+}
+
+/** Private API **/
+
+/*
+ * Called by m_mem_unref() when last reference to a pool buffer is dropped,
+ * possibly by any thread: cache the buffer for later reuse, if possible.
+ * Sealed buffers are never reused, as other processes may still be reading them.
+ */
+void pool_release(mem_header_t *header) {
+    m_mem_pool_t *pool = header->pool;
+    pool_block_t *b = get_block(header);
+    bool cached = false;
+
+    if (b->cls != M_MEM_POOL_NO_CLASS && !b->sealed) {
+        pthread_mutex_lock(&pool->mx);
+        if (!pool->closed && pool->cached[b->cls] < M_MEM_POOL_MAX_CACHED) {
+            *free_link(header) = pool->free[b->cls];
+            pool->free[b->cls] = header;
+            pool->cached[b->cls]++;
+            cached = true;
+        }
+        pthread_mutex_unlock(&pool->mx);
+    }
+
+    if (!cached) {
+        block_free(header);
+    }
+    m_mem_unref(pool);
+}
+
+/** Public API **/
+
+_public_ m_mem_pool_t *m_mem_pool_new(m_mem_pool_flags flags) {
+#ifndef MFD_ALLOW_SEALING
+    M_RET_ASSERT(!(flags & M_MEM_POOL_MEMFD), NULL);
+#endif
+
+    m_mem_pool_t *pool = m_mem_new(sizeof(m_mem_pool_t), pool_dtor);
+    if (pool) {
+        pool->mx = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+        pool->flags = flags;
+    }
+    return pool;
+}
+
+/*
+ * Take a ref counted buffer of at least size bytes from pool;
+ * buffer goes back to pool when its last reference is dropped (m_mem_unref()).
+ * Note that, differently from m_mem_new(), buffer is not zeroed.
+ */
+_public_ void *m_mem_pool_alloc(m_mem_pool_t *pool, size_t size, m_ref_dtor dtor) {
+    M_RET_ASSERT(pool, NULL);
+    M_RET_ASSERT(size < SIZE_MAX - M_MEM_POOL_DATA_OFF, NULL);
+
+    const size_t len = size + M_MEM_POOL_DATA_OFF;
+    const uint8_t cls = size_class(len);
+    mem_header_t *header = NULL;
+
+    if (cls != M_MEM_POOL_NO_CLASS) {
+        pthread_mutex_lock(&pool->mx);
+        header = pool->free[cls];
+        if (header) {
+            pool->free[cls] = *free_link(header);
+            pool->cached[cls]--;
+        }
+        pthread_mutex_unlock(&pool->mx);
+    }
+
+    if (!header) {
+        /* Oversized buffers are exactly sized, and never cached */
+        header = block_new(pool, cls != M_MEM_POOL_NO_CLASS ? (size_t)1 << (cls + M_MEM_POOL_MIN_SHIFT) : len, cls);
+        if (!header) {
+            return NULL;
+        }
+    }
+    return mem_header_init(header, M_MEM_POOL_DATA_OFF - sizeof(mem_header_t), size, dtor, m_mem_ref(pool));
+}
+
+/*
+ * Release pool: cached buffers are destroyed,
+ * while outstanding ones will be destroyed when their last reference is dropped.
+ */
+_public_ int m_mem_pool_free(m_mem_pool_t **pool) {
+    M_PARAM_ASSERT(pool && *pool);
+
+    m_mem_pool_t *p = *pool;
+    pthread_mutex_lock(&p->mx);
+    p->closed = true;
+    pool_flush(p);
+    pthread_mutex_unlock(&p->mx);
+
+    *pool = m_mem_unref(p);
+    return 0;
+}
+
+/*
+ * Seal a memfd backed buffer: its size can no more change
+ * and no new writable mapping can be created,
+ * so that it can be safely shared with other processes (see m_mem_fd()).
+ * Writer still owns its mapping: fill the buffer before sharing it.
+ */
+_public_ int m_mem_seal(void *src) {
+    M_PARAM_ASSERT(src);
+
+    mem_header_t *header = mem_get_header(src);
+    M_PARAM_ASSERT(header->pool);
+
+    pool_block_t *b = get_block(header);
+    M_RET_ASSERT(b->fd != -1, -ENOTSUP);
+    if (!b->sealed) {
+        int seals = F_SEAL_SHRINK | F_SEAL_GROW;
+#ifdef F_SEAL_FUTURE_WRITE
+        seals |= F_SEAL_FUTURE_WRITE;
+#endif
+        if (fcntl(b->fd, F_ADD_SEALS, seals) == -1) {
+            return -errno;
+        }
+        b->sealed = true;
+    }
+    return 0;
+}
+
+/*
+ * Get the memfd backing a buffer, and the offset of user data inside it:
+ * the fd can be sent to another process (eg: through SCM_RIGHTS),
+ * that will mmap it to read the buffer without any copy.
+ */
+_public_ int m_mem_fd(void *src, size_t *offset) {
+    M_PARAM_ASSERT(src);
+
+    mem_header_t *header = mem_get_header(src);
+    M_PARAM_ASSERT(header->pool);
+
+    pool_block_t *b = get_block(header);
+    M_RET_ASSERT(b->fd != -1, -ENOTSUP);
+    if (offset) {
+        *offset = M_MEM_POOL_DATA_OFF;
+    }
+    return b->fd;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "mem.h"
+#include <sys/types.h>
+
+/** Memory pool interface **/
+
+typedef enum {
+    M_MEM_POOL_MEMFD        = 1 << 0,         // back buffers by memfds, that can be sealed and shared with other processes
+} m_mem_pool_flags;
+
+/* Incomplete struct declaration for memory pool */
+typedef struct _mem_pool m_mem_pool_t;
+
+m_mem_pool_t *m_mem_pool_new(m_mem_pool_flags flags);
+void *m_mem_pool_alloc(m_mem_pool_t *pool, size_t size, m_ref_dtor dtor);
+int m_mem_pool_free(m_mem_pool_t **pool);
+
+/* Only for buffers allocated from a M_MEM_POOL_MEMFD pool */
+int m_mem_seal(void *src);
+int m_mem_fd(void *src, size_t *offset);
@@ -15,6 +15,16 @@ void fetch_ms(uint64_t *val, uint64_t *ctr) {
     }
 }
 
+void fetch_ns(uint64_t *val) {
+    struct timespec spec;
+#ifdef CLOCK_BOOTTIME
+    clock_gettime(CLOCK_BOOTTIME, &spec);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+#endif
+    *val = (uint64_t)spec.tv_sec * 1000000000 + spec.tv_nsec;
+}
+
 bool str_not_empty(const char *str) {
     return str && str[0] != '\0';
 }
@@ -4,4 +4,5 @@
 #include <stdbool.h>
 
 void fetch_ms(uint64_t *val, uint64_t *ctr);
+void fetch_ns(uint64_t *val);
 bool str_not_empty(const char *str);
@@ -86,6 +86,9 @@ int main(void) {
         /* Now topic has been registered, subscribe should work */
         cmocka_unit_test(test_mod_subscribe),
         
+        /* Subscribe to a regex matching same topic: a published message must still be received once */
+        cmocka_unit_test(test_mod_subscribe_regex),
+        
         /* Test module ref */
         cmocka_unit_test(test_mod_ref_NULL_name),
         cmocka_unit_test(test_mod_ref_unexhistent_name),
@@ -102,6 +105,9 @@ int main(void) {
         cmocka_unit_test(test_mod_publish_NULL_msg),
         cmocka_unit_test(test_mod_publish),
         
+        /* "topic" is a literal subscription: it must not match "xtopic" */
+        cmocka_unit_test(test_mod_publish_literal),
+        
         /* Test module broadcast */
         cmocka_unit_test(test_mod_broadcast_NULL_self),
         cmocka_unit_test(test_mod_broadcast_NULL_msg),
@@ -139,6 +145,24 @@ int main(void) {
          * the context gets automatically deregistered too, even if it was looping.
          */
         cmocka_unit_test(test_ctx_mod_deregister_during_loop),
+        
+        /* Test that modules can talk to modules living in another ctx (ie: in another thread) */
+        cmocka_unit_test(test_ctx_cross_ctx_msgs),
+        
+        /* Test modules' mailbox capacity and overflow policies */
+        cmocka_unit_test(test_ctx_mbox_overflow),
+        
+        /* Test that high priority messages overtake mailbox backlog */
+        cmocka_unit_test(test_ctx_mbox_priority),
+        
+        /* Test that last-value subscriptions replace their undelivered message */
+        cmocka_unit_test(test_ctx_mbox_conflate),
+        
+        /* Test publishing and subscribing through interned topic handles */
+        cmocka_unit_test(test_ctx_interned_topics),
+        
+        /* Test request/reply messages, and their timeouts */
+        cmocka_unit_test(test_ctx_ask),
 
         /* Test Map API */
         cmocka_unit_test(test_map_put),
@@ -193,8 +217,15 @@ int main(void) {
         
         /* Test poll plugin performance */
         cmocka_unit_test(test_poll_perf),
+        
+        /* Test publish fan-out performance */
+        cmocka_unit_test(test_publish_perf),
+        
+        /* Test that modules startup cost does not grow with the square of modules */
+        cmocka_unit_test(test_startup_perf),
 
         cmocka_unit_test(test_mem),
+        cmocka_unit_test(test_mem_pool),
 
         /* Test thpool API */
         cmocka_unit_test(test_thpool),
@@ -3,6 +3,9 @@
 #include <module/mod.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <errno.h>
+#include <unistd.h>
 
 #define CTX "testCtx"
 
@@ -111,6 +114,407 @@ static void my_recv(m_mod_t *mod, const m_queue_t *const evts) {
     });
 }
 
+static pthread_barrier_t cross_barrier;
+static m_mod_t *cross_mod;
+static int cross_ctr;
+
+static void cross_recv(m_mod_t *mod, const m_queue_t *const evts) {
+    m_itr_foreach(evts, {
+        m_evt_t *msg = m_itr_get(m_itr);
+        if (msg->type == M_SRC_TYPE_PS && !msg->ps_evt->system) {
+            assert_string_equal(msg->ps_evt->data, "hi!");
+            if (++cross_ctr == 2) {
+                m_ctx_quit(0);
+            }
+        }
+    });
+}
+
+static void *cross_thread(void *data) {
+    int ret = m_ctx_register("cross", 0, NULL);
+    assert_true(ret == 0);
+    
+    m_mod_hook_t hook = { .on_evt = cross_recv };
+    ret = m_mod_register("crossMod", &cross_mod, &hook, 0, NULL);
+    assert_true(ret == 0);
+    
+    ret = m_mod_ps_subscribe(cross_mod, "cross.topic", 0, NULL);
+    assert_true(ret == 0);
+    
+    /* Module is ready: let main thread send messages */
+    pthread_barrier_wait(&cross_barrier);
+    
+    ret = m_ctx_loop();
+    assert_int_equal(ret, 0);
+    
+    /* Let main thread check received messages before destroying our module */
+    pthread_barrier_wait(&cross_barrier);
+    
+    ret = m_mod_deregister(&cross_mod);
+    assert_int_equal(ret, 0);
+    return NULL;
+}
+
+void test_ctx_cross_ctx_msgs(void **state) {
+    (void) state; /* unused */
+    
+    pthread_t th;
+    pthread_barrier_init(&cross_barrier, NULL, 2);
+    pthread_create(&th, NULL, cross_thread, NULL);
+    
+    int ret = m_ctx_register("test", 0, NULL);
+    assert_true(ret == 0);
+    
+    m_mod_hook_t hook = { .on_evt = cross_recv };
+    m_mod_t *mod = NULL;
+    ret = m_mod_register("testName", &mod, &hook, 0, NULL);
+    assert_true(ret == 0);
+    
+    pthread_barrier_wait(&cross_barrier);
+    
+    /* Directly tell a message to a module living in another ctx */
+    ret = m_mod_ps_tell(mod, cross_mod, "hi!", 0);
+    assert_int_equal(ret, 0);
+    
+    /* Publish a message to subscribers of every ctx */
+    ret = m_mod_ps_publish(mod, "cross.topic", "hi!", M_PS_GLOBAL);
+    assert_int_equal(ret, 0);
+    
+    pthread_barrier_wait(&cross_barrier);
+    assert_int_equal(cross_ctr, 2);
+    
+    pthread_join(th, NULL);
+    pthread_barrier_destroy(&cross_barrier);
+    
+    ret = m_mod_deregister(&mod);
+    assert_int_equal(ret, 0);
+}
+
+static char mbox_recv_str[8];
+
+static void mbox_recv(m_mod_t *mod, const m_queue_t *const evts) {
+    m_itr_foreach(evts, {
+        m_evt_t *msg = m_itr_get(m_itr);
+        if (msg->type == M_SRC_TYPE_PS) {
+            strncat(mbox_recv_str, msg->ps_evt->data, sizeof(mbox_recv_str) - strlen(mbox_recv_str) - 1);
+        }
+    });
+}
+
+void test_ctx_mbox_overflow(void **state) {
+    (void) state; /* unused */
+    
+    int ret = m_ctx_register("test", 0, NULL);
+    assert_true(ret == 0);
+    
+    m_mod_hook_t hook = { .on_evt = mbox_recv };
+    m_mod_t *mod = NULL;
+    ret = m_mod_register("testName", &mod, &hook, 0, NULL);
+    assert_true(ret == 0);
+    m_mod_start(mod);
+    
+    ret = m_mod_set_mailbox(mod, 0, M_MOD_MBOX_REJECT);
+    assert_false(ret == 0);
+    
+    /* A full mailbox rejects any new message */
+    ret = m_mod_set_mailbox(mod, 2, M_MOD_MBOX_REJECT);
+    assert_true(ret == 0);
+    ret = m_mod_ps_tell(mod, mod, "a", 0);
+    assert_int_equal(ret, 0);
+    ret = m_mod_ps_tell(mod, mod, "b", 0);
+    assert_int_equal(ret, 0);
+    ret = m_mod_ps_tell(mod, mod, "c", 0);
+    assert_int_equal(ret, -EAGAIN);
+    
+    /* Oldest message is now dropped to make room */
+    ret = m_mod_set_mailbox(mod, 2, M_MOD_MBOX_DROP_OLDEST);
+    assert_true(ret == 0);
+    ret = m_mod_ps_tell(mod, mod, "d", 0);
+    assert_int_equal(ret, 0);
+    
+    /* New message is silently dropped */
+    ret = m_mod_set_mailbox(mod, 2, M_MOD_MBOX_DROP_NEWEST);
+    assert_true(ret == 0);
+    ret = m_mod_ps_tell(mod, mod, "e", 0);
+    assert_int_equal(ret, 0);
+    
+    m_mod_stats_t stats;
+    ret = m_mod_stats(mod, &stats);
+    assert_true(ret == 0);
+    assert_int_equal(stats.dropped_msgs, 3);
+    assert_int_equal(stats.mbox_high_watermark, 2);
+    
+    ret = m_ctx_dispatch();
+    assert_true(ret == 0);  // loop started
+    
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 2);
+    assert_string_equal(mbox_recv_str, "bd");
+    
+    ret = m_ctx_quit(0);
+    assert_true(ret == 0);
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 0);
+    
+    ret = m_mod_deregister(&mod);
+    assert_int_equal(ret, 0);
+}
+
+void test_ctx_mbox_priority(void **state) {
+    (void) state; /* unused */
+    
+    int ret = m_ctx_register("test", 0, NULL);
+    assert_true(ret == 0);
+    
+    m_mod_hook_t hook = { .on_evt = mbox_recv };
+    m_mod_t *mod = NULL;
+    ret = m_mod_register("testName", &mod, &hook, 0, NULL);
+    assert_true(ret == 0);
+    m_mod_start(mod);
+    
+    ret = m_mod_ps_subscribe(mod, "norm", M_SRC_PRIO_NORM, NULL);
+    assert_true(ret == 0);
+    ret = m_mod_ps_subscribe(mod, "high", M_SRC_PRIO_HIGH, NULL);
+    assert_true(ret == 0);
+    
+    /* High priority message must overtake the backlog */
+    ret = m_mod_ps_publish(mod, "norm", "a", 0);
+    assert_true(ret == 0);
+    ret = m_mod_ps_publish(mod, "norm", "b", 0);
+    assert_true(ret == 0);
+    ret = m_mod_ps_publish(mod, "high", "c", 0);
+    assert_true(ret == 0);
+    
+    mbox_recv_str[0] = '\0';
+    ret = m_ctx_dispatch();
+    assert_true(ret == 0);  // loop started
+    
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 3);
+    assert_string_equal(mbox_recv_str, "cab");
+    
+    ret = m_ctx_quit(0);
+    assert_true(ret == 0);
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 0);
+    
+    ret = m_mod_deregister(&mod);
+    assert_int_equal(ret, 0);
+}
+
+void test_ctx_mbox_conflate(void **state) {
+    (void) state; /* unused */
+    
+    int ret = m_ctx_register("test", 0, NULL);
+    assert_true(ret == 0);
+    
+    m_mod_hook_t hook = { .on_evt = mbox_recv };
+    m_mod_t *mod = NULL;
+    ret = m_mod_register("testName", &mod, &hook, 0, NULL);
+    assert_true(ret == 0);
+    m_mod_start(mod);
+    
+    ret = m_mod_ps_subscribe(mod, "norm", 0, NULL);
+    assert_true(ret == 0);
+    ret = m_mod_ps_subscribe(mod, "price", M_SRC_PS_CONFLATE, NULL);
+    assert_true(ret == 0);
+    
+    /* Undelivered price is replaced in place by newer ones */
+    ret = m_mod_ps_publish(mod, "norm", "a", 0);
+    assert_true(ret == 0);
+    ret = m_mod_ps_publish(mod, "price", "1", 0);
+    assert_true(ret == 0);
+    ret = m_mod_ps_publish(mod, "price", "2", 0);
+    assert_true(ret == 0);
+    ret = m_mod_ps_publish(mod, "norm", "b", 0);
+    assert_true(ret == 0);
+    ret = m_mod_ps_publish(mod, "price", "3", 0);
+    assert_true(ret == 0);
+    
+    mbox_recv_str[0] = '\0';
+    ret = m_ctx_dispatch();
+    assert_true(ret == 0);  // loop started
+    
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 3);
+    assert_string_equal(mbox_recv_str, "a3b");
+    
+    /* Once delivered, next price takes a new mailbox slot */
+    ret = m_mod_ps_publish(mod, "price", "4", 0);
+    assert_true(ret == 0);
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 1);
+    assert_string_equal(mbox_recv_str, "a3b4");
+    
+    m_mod_stats_t stats;
+    ret = m_mod_stats(mod, &stats);
+    assert_true(ret == 0);
+    assert_int_equal(stats.conflated_msgs, 2);
+    
+    ret = m_ctx_quit(0);
+    assert_true(ret == 0);
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 0);
+    
+    ret = m_mod_deregister(&mod);
+    assert_int_equal(ret, 0);
+}
+
+static m_ps_topic_t interned_topic;
+static int interned_ctr;
+
+static void topic_recv(m_mod_t *mod, const m_queue_t *const evts) {
+    m_itr_foreach(evts, {
+        m_evt_t *msg = m_itr_get(m_itr);
+        if (msg->type == M_SRC_TYPE_PS) {
+            assert_int_equal(msg->ps_evt->topic_id, interned_topic);
+            assert_string_equal(msg->ps_evt->topic, "orders.new");
+            interned_ctr++;
+        }
+    });
+}
+
+void test_ctx_interned_topics(void **state) {
+    (void) state; /* unused */
+    
+    assert_int_equal(m_ps_topic_intern(NULL), M_PS_TOPIC_NONE);
+    interned_topic = m_ps_topic_intern("orders.new");
+    assert_true(interned_topic != M_PS_TOPIC_NONE);
+    assert_int_equal(m_ps_topic_intern("orders.new"), interned_topic);
+    assert_string_equal(m_ps_topic_name(interned_topic), "orders.new");
+    
+    int ret = m_ctx_register("test", 0, NULL);
+    assert_true(ret == 0);
+    
+    m_mod_hook_t hook = { .on_evt = topic_recv };
+    m_mod_t *mod = NULL;
+    ret = m_mod_register("testName", &mod, &hook, 0, NULL);
+    assert_true(ret == 0);
+    m_mod_start(mod);
+    
+    ret = m_mod_ps_subscribe_topic(mod, M_PS_TOPIC_NONE, 0, NULL);
+    assert_false(ret == 0);
+    ret = m_mod_ps_subscribe_topic(mod, interned_topic, 0, NULL);
+    assert_true(ret == 0);
+    
+    /* System topics cannot be published by users */
+    ret = m_mod_ps_publish_topic(mod, m_ps_topic_intern(M_PS_CTX_STARTED), "hi!", 0);
+    assert_int_equal(ret, -EPERM);
+    
+    /* Publishing by handle or by name is equivalent */
+    ret = m_mod_ps_publish_topic(mod, interned_topic, "hi!", 0);
+    assert_true(ret == 0);
+    ret = m_mod_ps_publish(mod, "orders.new", "hi!", 0);
+    assert_true(ret == 0);
+    
+    ret = m_ctx_dispatch();
+    assert_true(ret == 0);  // loop started
+    
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 2);
+    assert_int_equal(interned_ctr, 2);
+    
+    ret = m_mod_ps_unsubscribe_topic(mod, interned_topic);
+    assert_true(ret == 0);
+    
+    ret = m_ctx_quit(0);
+    assert_true(ret == 0);
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 0);
+    
+    ret = m_mod_deregister(&mod);
+    assert_int_equal(ret, 0);
+}
+
+static int ask_replied;
+static int ask_timedout;
+static const m_mod_t *ask_server;
+
+static void ask_server_recv(m_mod_t *mod, const m_queue_t *const evts) {
+    m_itr_foreach(evts, {
+        m_evt_t *msg = m_itr_get(m_itr);
+        if (msg->type == M_SRC_TYPE_PS && !msg->ps_evt->system) {
+            if (!msg->ps_evt->ask) {
+                /* Only requests can be replied */
+                assert_false(m_mod_ps_reply(mod, msg->ps_evt, "pong", 0) == 0);
+            } else if (strcmp(msg->ps_evt->data, "ping") == 0) {
+                assert_int_equal(m_mod_ps_reply(mod, msg->ps_evt, "pong", 0), 0);
+            }
+        }
+    });
+}
+
+static void ask_client_recv(m_mod_t *mod, const m_queue_t *const evts) {
+    m_itr_foreach(evts, {
+        m_evt_t *msg = m_itr_get(m_itr);
+        if (msg->type == M_SRC_TYPE_ASK) {
+            if (msg->ask_evt->timedout) {
+                assert_string_equal(msg->userdata, "ignore");
+                assert_null(msg->ask_evt->responder);
+                assert_null(msg->ask_evt->data);
+                ask_timedout++;
+            } else {
+                assert_string_equal(msg->userdata, "ping");
+                assert_ptr_equal(msg->ask_evt->responder, ask_server);
+                assert_string_equal(msg->ask_evt->data, "pong");
+                ask_replied++;
+            }
+        }
+    });
+}
+
+void test_ctx_ask(void **state) {
+    (void) state; /* unused */
+    
+    int ret = m_ctx_register("test", 0, NULL);
+    assert_true(ret == 0);
+    
+    m_mod_hook_t hook = { .on_evt = ask_server_recv };
+    m_mod_t *server = NULL;
+    ret = m_mod_register("server", &server, &hook, 0, NULL);
+    assert_true(ret == 0);
+    m_mod_start(server);
+    ask_server = server;
+    
+    hook.on_evt = ask_client_recv;
+    m_mod_t *client = NULL;
+    ret = m_mod_register("client", &client, &hook, 0, NULL);
+    assert_true(ret == 0);
+    m_mod_start(client);
+    
+    ret = m_mod_ps_ask(client, server, "ping", 0, "ping");
+    assert_false(ret == 0);
+    
+    /* First request is replied, second one will time out */
+    ret = m_mod_ps_ask(client, server, "ping", 10 * 1000 * 1000 * 1000ull, "ping");
+    assert_true(ret == 0);
+    ret = m_mod_ps_ask(client, server, "ignore", 1000 * 1000, "ignore");
+    assert_true(ret == 0);
+    ret = m_mod_ps_tell(client, server, "hi", 0);
+    assert_true(ret == 0);
+    
+    ret = m_ctx_dispatch();
+    assert_true(ret == 0);  // loop started
+    
+    for (int i = 0; i < 1000 && ask_replied + ask_timedout < 2; i++) {
+        ret = m_ctx_dispatch();
+        assert_true(ret >= 0);
+        usleep(1000);
+    }
+    assert_int_equal(ask_replied, 1);
+    assert_int_equal(ask_timedout, 1);
+    
+    ret = m_ctx_quit(0);
+    assert_true(ret == 0);
+    ret = m_ctx_dispatch();
+    assert_int_equal(ret, 0);
+    
+    ret = m_mod_deregister(&client);
+    assert_int_equal(ret, 0);
+    ret = m_mod_deregister(&server);
+    assert_int_equal(ret, 0);
+}
+
 void test_ctx_mod_deregister_during_loop(void **state) {
     (void) state; /* unused */
 
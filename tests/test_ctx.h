@@ -10,3 +10,9 @@ void test_ctx_quit_no_loop(void **state);
 void test_ctx_loop(void **state);
 void test_ctx_dispatch(void **state);
 void test_ctx_mod_deregister_during_loop(void **state);
+void test_ctx_cross_ctx_msgs(void **state);
+void test_ctx_mbox_overflow(void **state);
+void test_ctx_mbox_priority(void **state);
+void test_ctx_mbox_conflate(void **state);
+void test_ctx_interned_topics(void **state);
+void test_ctx_ask(void **state);
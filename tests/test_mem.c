@@ -1,5 +1,9 @@
 #include "test_mem.h"
 #include <module/mem/mem.h>
+#include <module/mem/pool.h>
+#include <sys/mman.h>
+#include <string.h>
+#include <errno.h>
 #include <stddef.h>
 #include <stdalign.h>
 #include <stdlib.h>
@@ -21,3 +25,46 @@ void test_mem(void **state) {
         assert_null(data);
     }
 }
+
+void test_mem_pool(void **state) {
+    (void) state; /* unused */
+    
+    m_mem_pool_t *pool = m_mem_pool_new(M_MEM_POOL_MEMFD);
+    assert_non_null(pool);
+    
+    void *buf = m_mem_pool_alloc(pool, 64 * 1024, NULL);
+    assert_non_null(buf);
+    assert_int_equal(m_mem_size(buf), 64 * 1024);
+    memset(buf, 'x', 64 * 1024);
+    
+    /* Released buffers are reused for same size class */
+    void *old = buf;
+    m_mem_unrefp(&buf);
+    buf = m_mem_pool_alloc(pool, 100 * 1024, NULL);
+    assert_ptr_equal(buf, old);
+    
+    /* Plain memory objects are not backed by any memfd */
+    void *data = m_mem_new(10, NULL);
+    assert_int_equal(m_mem_fd(data, NULL), -EINVAL);
+    m_mem_unrefp(&data);
+    
+    /* Sealed buffer can be mapped (read-only) by anyone holding its fd */
+    strcpy(buf, "Hello World");
+    assert_int_equal(m_mem_seal(buf), 0);
+    size_t off;
+    int fd = m_mem_fd(buf, &off);
+    assert_true(fd >= 0);
+    assert_true(mmap(NULL, off + 64 * 1024, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) == MAP_FAILED);
+    char *map = mmap(NULL, off + 64 * 1024, PROT_READ, MAP_SHARED, fd, 0);
+    assert_true(map != MAP_FAILED);
+    assert_string_equal(map + off, "Hello World");
+    munmap(map, off + 64 * 1024);
+    
+    /* Outstanding buffers outlive their pool */
+    void *large = m_mem_pool_alloc(pool, 16 * 1024 * 1024, NULL);
+    assert_non_null(large);
+    assert_int_equal(m_mem_pool_free(&pool), 0);
+    assert_null(pool);
+    m_mem_unrefp(&buf);
+    m_mem_unrefp(&large);
+}
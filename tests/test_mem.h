@@ -1,3 +1,4 @@
 #include "test_commons.h"
 
-void test_mem(void **state);
\ No newline at end of file
+void test_mem(void **state);
+void test_mem_pool(void **state);
\ No newline at end of file
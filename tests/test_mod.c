@@ -318,6 +318,13 @@ void test_mod_subscribe(void **state) {
     assert_true(ret == 0);
 }
 
+void test_mod_subscribe_regex(void **state) {
+    (void) state; /* unused */
+
+    int ret = m_mod_ps_subscribe(test_mod, "^to", 0, NULL);
+    assert_true(ret == 0);
+}
+
 void test_mod_ref_NULL_name(void **state) {
     (void) state; /* unused */
     
@@ -404,6 +411,13 @@ void test_mod_publish(void **state) {
     assert_true(ret == 0);
 }
 
+void test_mod_publish_literal(void **state) {
+    (void) state; /* unused */
+    
+    int ret = m_mod_ps_publish(test_mod, "xtopic", (unsigned char *)"hi!", 0);
+    assert_true(ret == 0);
+}
+
 void test_mod_broadcast_NULL_self(void **state) {
     (void) state; /* unused */
     
@@ -34,6 +34,7 @@ void test_mod_rm_fd(void **state);
 void test_mod_subscribe_NULL_topic(void **state);
 void test_mod_subscribe_NULL_self(void **state);
 void test_mod_subscribe(void **state);
+void test_mod_subscribe_regex(void **state);
 void test_mod_ref_NULL_name(void **state);
 void test_mod_ref_unexhistent_name(void **state);
 void test_mod_ref(void **state);
@@ -46,6 +47,7 @@ void test_mod_tell(void **state);
 void test_mod_publish_NULL_self(void **state);
 void test_mod_publish_NULL_msg(void **state);
 void test_mod_publish(void **state);
+void test_mod_publish_literal(void **state);
 void test_mod_broadcast_NULL_self(void **state);
 void test_mod_broadcast_NULL_msg(void **state);
 void test_mod_broadcast(void **state);
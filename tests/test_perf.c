@@ -4,8 +4,14 @@
 #include <time.h>
 
 #define MAX_LEN 5000
+#define NUM_SUBS 500
+#define NUM_PUBS 100
+#define NUM_MODS 5000
 
 static void my_recv(m_mod_t *mod, const m_queue_t *const evts);
+static void sub_recv(m_mod_t *mod, const m_queue_t *const evts);
+static void watcher_recv(m_mod_t *mod, const m_queue_t *const evts);
+static void startup_recv(m_mod_t *mod, const m_queue_t *const evts);
 
 static m_mod_t *mod;
 static int ctr;
@@ -58,6 +64,90 @@ void test_poll_perf(void **state) {
     assert_int_equal(ret, 0);
 }
 
+void test_publish_perf(void **state) {
+    (void) state; /* unused */
+
+    int ret = m_ctx_register("perf", 0, NULL);
+    assert_true(ret == 0);
+    
+    m_mod_t *subs[NUM_SUBS];
+    m_mod_hook_t hook = { .on_evt = sub_recv };
+    for (int i = 0; i < NUM_SUBS; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "sub%d", i);
+        ret = m_mod_register(name, &subs[i], &hook, M_MOD_NAME_DUP, NULL);
+        assert_true(ret == 0);
+        
+        m_mod_start(subs[i]);
+        ret = m_mod_ps_subscribe(subs[i], "perf.topic", 0, NULL);
+        assert_true(ret == 0);
+    }
+    
+    ctr = 0;
+    clock_t begin_pub = clock();
+    for (int i = 0; i < NUM_PUBS; i++) {
+        /* Payload must be freed just once, after last subscriber received it */
+        ret = m_mod_ps_publish(subs[0], "perf.topic", strdup("Hello World"), M_PS_AUTOFREE);
+        assert_int_equal(ret, 0);
+    }
+    clock_t end_pub = clock();
+    double time_spent = (double)(end_pub - begin_pub);
+    printf("Messages publishing took %.2lf us\n", time_spent);
+    
+    m_ctx_loop();
+    
+    clock_t end_recv = clock();
+    time_spent = (double)(end_recv - end_pub);
+    printf("Published messages fetching took %.2lf us\n", time_spent);
+    assert_int_equal(ctr, NUM_SUBS * NUM_PUBS);
+    
+    for (int i = 0; i < NUM_SUBS; i++) {
+        ret = m_mod_deregister(&subs[i]);
+        assert_int_equal(ret, 0);
+    }
+}
+
+void test_startup_perf(void **state) {
+    (void) state; /* unused */
+
+    int ret = m_ctx_register("perf", 0, NULL);
+    assert_true(ret == 0);
+    
+    /* Only the watcher is subscribed to modules' lifecycle messages */
+    m_mod_t *watcher = NULL;
+    m_mod_hook_t hook = { .on_evt = watcher_recv };
+    ret = m_mod_register("watcher", &watcher, &hook, 0, NULL);
+    assert_true(ret == 0);
+    m_mod_start(watcher);
+    ret = m_mod_ps_subscribe(watcher, M_PS_MOD_STARTED, 0, NULL);
+    assert_true(ret == 0);
+    
+    static m_mod_t *mods[NUM_MODS];
+    hook.on_evt = startup_recv;
+    for (int i = 0; i < NUM_MODS; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "mod%d", i);
+        ret = m_mod_register(name, &mods[i], &hook, M_MOD_NAME_DUP, NULL);
+        assert_true(ret == 0);
+    }
+    
+    /* Modules are started by the loop */
+    ctr = 0;
+    clock_t begin = clock();
+    m_ctx_loop();
+    clock_t end = clock();
+    double time_spent = (double)(end - begin);
+    printf("Modules startup took %.2lf us\n", time_spent);
+    assert_int_equal(ctr, NUM_MODS);
+    
+    for (int i = 0; i < NUM_MODS; i++) {
+        ret = m_mod_deregister(&mods[i]);
+        assert_int_equal(ret, 0);
+    }
+    ret = m_mod_deregister(&watcher);
+    assert_int_equal(ret, 0);
+}
+
 static void my_recv(m_mod_t *mod, const m_queue_t *const evts) {
     m_itr_foreach(evts, {
         m_evt_t *msg = m_itr_get(m_itr);
@@ -70,3 +160,26 @@ static void my_recv(m_mod_t *mod, const m_queue_t *const evts) {
         }
     });
 }
+
+static void sub_recv(m_mod_t *mod, const m_queue_t *const evts) {
+    m_itr_foreach(evts, {
+        m_evt_t *msg = m_itr_get(m_itr);
+        if (msg->type == M_SRC_TYPE_PS && !msg->ps_evt->system && ++ctr == NUM_SUBS * NUM_PUBS) {
+            m_ctx_quit(0);
+        }
+    });
+}
+
+static void watcher_recv(m_mod_t *mod, const m_queue_t *const evts) {
+    m_itr_foreach(evts, {
+        m_evt_t *msg = m_itr_get(m_itr);
+        if (msg->type == M_SRC_TYPE_PS && msg->ps_evt->topic_id == m_ps_topic_intern(M_PS_MOD_STARTED) && ++ctr == NUM_MODS) {
+            m_ctx_quit(0);
+        }
+    });
+}
+
+/* Modules not subscribed to any system topic must never be told one */
+static void startup_recv(m_mod_t *mod, const m_queue_t *const evts) {
+    fail();
+}
@@ -1,3 +1,5 @@
 #include "test_commons.h"
 
 void test_poll_perf(void **state);
+void test_publish_perf(void **state);
+void test_startup_perf(void **state);